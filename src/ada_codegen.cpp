@@ -35,54 +35,35 @@ void gen(std::vector<std::shared_ptr<mdl::Module>>& program) {
         d->printClass();
     }
 
+    node::StringLiteral::codegenCache();
     cg.printClass(InnerSubprograms);
+    // jar должен запускаться сам по себе, без java/ в classpath
+    cg.addJarResource(AdaUtility->name() + ".class", adaUtilityClass());
+    // main - в inner_subprograms
+    cg.finishOutput(InnerSubprograms);
 }
 
 jvm_class::SharedPtrJVMClass InnerSubprograms;
 
-jvm_class::SharedPtrJVMClass StringBuiler;
 jvm_class::SharedPtrJVMClass PrintStream; 
-jvm_class::SharedPtrJVMClass AtomicInteger;
-jvm_class::SharedPtrJVMClass AtomicBoolean;
-jvm_class::SharedPtrJVMClass AtomicReference;
 jvm_class::SharedPtrJVMClass AdaUtility; 
 jvm_class::SharedPtrJVMClass JavaObject;
 jvm_class::SharedPtrJVMClass JavaString;
+jvm_class::SharedPtrJVMClass JavaSystem;
+jvm_class::SharedPtrJVMClass JavaIndexException;
 
-class_member::SharedPtrMethod AdaUtilityInitArrayElements;
 class_member::SharedPtrMethod AdaUtilityJavaObjectInit;
-class_member::SharedPtrMethod AdaUtilityStringBuilderInit;
 
-class_member::SharedPtrMethod AdaUtilityDeepCopy;
-class_member::SharedPtrMethod AdaUtilityDeepCopyArray;
-class_member::SharedPtrMethod AdaUtilityCopyStringBuilder;
-
-class_member::SharedPtrMethod AdaUtilityToAtomicBoolean;
-class_member::SharedPtrMethod AdaUtilityToAtomicInt;
-class_member::SharedPtrMethod AdaUtilityToAtomicFloat;
-class_member::SharedPtrMethod AdaUtilityToAtomicChar;
-
-class_member::SharedPtrMethod AdaUtilityFromAtomicBoolean;
-class_member::SharedPtrMethod AdaUtilityFromAtomicInt;
-class_member::SharedPtrMethod AdaUtilityFromAtomicFloat;
-class_member::SharedPtrMethod AdaUtilityFromAtomicChar;
-
-class_member::SharedPtrMethod AdaUtilitySetAtomicBoolean;
-class_member::SharedPtrMethod AdaUtilitySetAtomicInt;
-class_member::SharedPtrMethod AdaUtilitySetAtomicFloat;
-class_member::SharedPtrMethod AdaUtilitySetAtomicChar;
-
-class_member::SharedPtrMethod AdaUtilitySetCharAt;
-class_member::SharedPtrMethod AdaUtilityCharAt;
-class_member::SharedPtrMethod AdaUtilityConcat;
-class_member::SharedPtrMethod AdaUtilityFromStringLiteral;
+class_member::SharedPtrMethod JavaSystemArraycopy;
+class_member::SharedPtrMethod JavaIndexExceptionInit;
+class_member::SharedPtrMethod JavaStringToCharArray;
 
 class_member::SharedPtrMethod AdaUtilityImageFromChar;
 class_member::SharedPtrMethod AdaUtilityImageFromInt;
 class_member::SharedPtrMethod AdaUtilityImageFromBool;
 class_member::SharedPtrMethod AdaUtilityImageFromFloat;
 
-class_member::SharedPtrMethod AdaUtilityPrintStringBuilder;
+class_member::SharedPtrMethod AdaUtilityPrintString;
 
 class_member::SharedPtrMethod AdaUtilityReadBool;
 class_member::SharedPtrMethod AdaUtilityReadInt;
@@ -97,21 +78,9 @@ void initAdaUtilityNames() {
     InnerSubprograms = cg.createClass(
         attribute::QualifiedName("inner_subprograms"));
 
-    StringBuiler = cg.createClass(
-        attribute::QualifiedName({"java", "lang", "StringBuilder"}));
-
     PrintStream = cg.createClass(
         attribute::QualifiedName({"java", "io", "PrintStream"}));
 
-    AtomicInteger = cg.createClass(
-        attribute::QualifiedName({"java", "util", "concurrent", "atomic", "AtomicInteger"}));
-
-    AtomicBoolean = cg.createClass(
-        attribute::QualifiedName({"java", "util", "concurrent", "atomic", "AtomicBoolean"}));
-
-    AtomicReference = cg.createClass(
-        attribute::QualifiedName({"java", "util", "concurrent", "atomic", "AtomicReference"}));
-
     AdaUtility = cg.createClass(
         attribute::QualifiedName({"AdaUtility"}));
 
@@ -121,184 +90,42 @@ void initAdaUtilityNames() {
     InnerSubprograms->setParent(JavaObject);
     JavaString = 
         cg.createClass(attribute::QualifiedName({"java", "lang", "String"}));
+    JavaSystem = 
+        cg.createClass(attribute::QualifiedName({"java", "lang", "System"}));
+    JavaIndexException = cg.createClass(
+        attribute::QualifiedName({"java", "lang", "ArrayIndexOutOfBoundsException"}));
 
-    // ------------------ методы ------------------
-    AdaUtilityInitArrayElements = AdaUtility->addMethod(
-        "initArrayElements",
-        JVMMethodDescriptor::createVoidRetun({{"src", JVMFieldDescriptor::createObject(JavaObject->name())}}));
+    // строки - char[]
+    auto chars = JVMFieldDescriptor::createFundamental(codegen::FundamentalType::CHAR);
+    chars.addDimension();
 
+    // ------------------ методы ------------------
     AdaUtilityJavaObjectInit = JavaObject->addMethod(
         "<init>", JVMMethodDescriptor::createVoidParamsVoidReturn());
 
-        
-    AdaUtilityStringBuilderInit = StringBuiler->addMethod(
-        "<init>", JVMMethodDescriptor::createVoidParamsVoidReturn());
-
-    AdaUtilityDeepCopy = AdaUtility->addMethod(
-        "deepCopy",
-        JVMMethodDescriptor::create(
-            {{"src", JVMFieldDescriptor::createObject(JavaObject->name())}},
-            JVMFieldDescriptor::createObject(JavaObject->name())
-        )
-    );
-
-    AdaUtilityDeepCopyArray = AdaUtility->addMethod(
-        "deepCopyArray",
-        JVMMethodDescriptor::create(
-            {{"srcArray", JVMFieldDescriptor::createObject(JavaObject->name())}},
-            JVMFieldDescriptor::createObject(JavaObject->name())
-        )
-    );
-
-    AdaUtilityCopyStringBuilder = AdaUtility->addMethod(
-        "copyStringBuilder",
-        JVMMethodDescriptor::create(
-            {{"src", JVMFieldDescriptor::createObject(StringBuiler->name())}},
-            JVMFieldDescriptor::createObject(StringBuiler->name())
-        )
-    );
-
-    // ---------- atomic ----------
-    AdaUtilityToAtomicBoolean = AdaUtility->addMethod(
-        "toAtomic",
-        JVMMethodDescriptor::create(
-            {{"value", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::BOOLEAN)}},
-            JVMFieldDescriptor::createObject(AtomicBoolean->name())
-        )
-    );
-
-    AdaUtilityToAtomicInt = AdaUtility->addMethod(
-        "toAtomic",
-        JVMMethodDescriptor::create(
-            {{"value", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::INT)}},
-            JVMFieldDescriptor::createObject(AtomicInteger->name())
-        )
-    );
-
-    AdaUtilityToAtomicFloat = AdaUtility->addMethod(
-        "toAtomic",
-        JVMMethodDescriptor::create(
-            {{"value", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::FLOAT)}},
-            JVMFieldDescriptor::createObject(AtomicReference->name())
-        )
-    );
-
-    AdaUtilityToAtomicChar = AdaUtility->addMethod(
-        "toAtomic",
-        JVMMethodDescriptor::create(
-            {{"value", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::CHAR)}},
-            JVMFieldDescriptor::createObject(AtomicInteger->name())
-        )
-    );
-
-    // ---------- fromAtomic ----------
-    AdaUtilityFromAtomicBoolean = AdaUtility->addMethod(
-        "fromAtomic",
-        JVMMethodDescriptor::create(
-            {{"atomic", JVMFieldDescriptor::createObject(AtomicBoolean->name())}},
-            JVMFieldDescriptor::createFundamental(codegen::FundamentalType::BOOLEAN)
-        )
-    );
-
-    AdaUtilityFromAtomicInt = AdaUtility->addMethod(
-        "fromAtomic",
-        JVMMethodDescriptor::create(
-            {{"atomic", JVMFieldDescriptor::createObject(AtomicInteger->name())}},
-            JVMFieldDescriptor::createFundamental(codegen::FundamentalType::INT)
-        )
-    );
-
-    AdaUtilityFromAtomicFloat = AdaUtility->addMethod(
-        "fromAtomic",
-        JVMMethodDescriptor::create(
-            {{"atomic", JVMFieldDescriptor::createObject(AtomicReference->name())}},
-            JVMFieldDescriptor::createFundamental(codegen::FundamentalType::FLOAT)
-        )
-    );
-
-    AdaUtilityFromAtomicChar = AdaUtility->addMethod(
-        "fromAtomicChar",
-        JVMMethodDescriptor::create(
-            {{"atomic", JVMFieldDescriptor::createObject(AtomicInteger->name())}},
-            JVMFieldDescriptor::createFundamental(codegen::FundamentalType::CHAR)
-        )
-    );
-
-    // ---------- setAtomic ----------
-    AdaUtilitySetAtomicBoolean = AdaUtility->addMethod(
-        "setAtomic",
-        JVMMethodDescriptor::createVoidRetun({
-            {"atomic", JVMFieldDescriptor::createObject(AtomicInteger->name())},
-            {"value", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::BOOLEAN)}
-        })
-    );
-
-    AdaUtilitySetAtomicInt = AdaUtility->addMethod(
-        "setAtomic",
-        JVMMethodDescriptor::createVoidRetun({
-            {"atomic", JVMFieldDescriptor::createObject(AtomicInteger->name())},
-            {"value", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::INT)}
-        })
-    );
-
-    AdaUtilitySetAtomicFloat = AdaUtility->addMethod(
-        "setAtomic",
-        JVMMethodDescriptor::createVoidRetun({
-            {"atomic", JVMFieldDescriptor::createObject(AtomicInteger->name())},
-            {"value", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::FLOAT)}
-        })
-    );
-
-    AdaUtilitySetAtomicChar = AdaUtility->addMethod(
-        "setAtomicChar",
-        JVMMethodDescriptor::createVoidRetun({
-            {"atomic", JVMFieldDescriptor::createObject(AtomicInteger->name())},
-            {"value", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::CHAR)}
-        })
-    );
-
-    // ---------- StringBuilder ----------
-    AdaUtilitySetCharAt = AdaUtility->addMethod(
-        "setCharAt",
+    JavaSystemArraycopy = JavaSystem->addMethod(
+        "arraycopy",
         JVMMethodDescriptor::createVoidRetun({
-            {"sb", JVMFieldDescriptor::createObject(StringBuiler->name())},
-            {"index", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::INT)},
-            {"value", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::CHAR)}
+            {"src", JVMFieldDescriptor::createObject(JavaObject->name())},
+            {"srcPos", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::INT)},
+            {"dest", JVMFieldDescriptor::createObject(JavaObject->name())},
+            {"destPos", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::INT)},
+            {"length", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::INT)}
         })
     );
 
-    AdaUtilityCharAt = AdaUtility->addMethod(
-        "charAt",
-        JVMMethodDescriptor::create(
-            {{"sb", JVMFieldDescriptor::createObject(StringBuiler->name())},
-             {"index", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::INT)}},
-            JVMFieldDescriptor::createFundamental(codegen::FundamentalType::CHAR)
-        )
-    );
-
-    AdaUtilityConcat = AdaUtility->addMethod(
-        "concat",
-        JVMMethodDescriptor::create(
-            {{"sb1", JVMFieldDescriptor::createObject(StringBuiler->name())},
-             {"sb2", JVMFieldDescriptor::createObject(StringBuiler->name())}},
-            JVMFieldDescriptor::createObject(StringBuiler->name())
-        )
-    );
+    JavaIndexExceptionInit = JavaIndexException->addMethod(
+        "<init>", JVMMethodDescriptor::createVoidParamsVoidReturn());
 
-    AdaUtilityFromStringLiteral = AdaUtility->addMethod(
-        "fromStringLiteral",
-        JVMMethodDescriptor::create(
-            {{"value", JVMFieldDescriptor::createObject(JavaString->name())}},
-            JVMFieldDescriptor::createObject(StringBuiler->name())
-        )
-    );
+    JavaStringToCharArray = JavaString->addMethod(
+        "toCharArray", JVMMethodDescriptor::createVoidParams(chars));
 
     // ---------- image ----------
     AdaUtilityImageFromChar = AdaUtility->addMethod(
         "imageFromChar",
         JVMMethodDescriptor::create(
             {{"value", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::CHAR)}},
-            JVMFieldDescriptor::createObject(StringBuiler->name())
+            chars
         )
     );
 
@@ -306,7 +133,7 @@ void initAdaUtilityNames() {
         "imageFromInt",
         JVMMethodDescriptor::create(
             {{"value", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::INT)}},
-            JVMFieldDescriptor::createObject(StringBuiler->name())
+            chars
         )
     );
 
@@ -314,7 +141,7 @@ void initAdaUtilityNames() {
         "imageFromBool",
         JVMMethodDescriptor::create(
             {{"value", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::BOOLEAN)}},
-            JVMFieldDescriptor::createObject(StringBuiler->name())
+            chars
         )
     );
 
@@ -322,49 +149,51 @@ void initAdaUtilityNames() {
         "imageFromFloat",
         JVMMethodDescriptor::create(
             {{"value", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::FLOAT)}},
-            JVMFieldDescriptor::createObject(StringBuiler->name())
+            chars
         )
     );
 
-    AdaUtilityPrintStringBuilder = AdaUtility->addMethod(
-        "printStringBuilder",
-        descriptor::JVMMethodDescriptor::createVoidRetun(
-            {{"sb", descriptor::JVMFieldDescriptor::createObject(StringBuiler->name())}}
-        )
+    AdaUtilityPrintString = AdaUtility->addMethod(
+        "printString",
+        JVMMethodDescriptor::createVoidRetun({{"str", chars}})
     );
 
     AdaUtilityReadBool = AdaUtility->addMethod(
         "readBool",
-        JVMMethodDescriptor::createVoidRetun({
-            {"atomic", JVMFieldDescriptor::createObject(AtomicBoolean->name())},
-        })
+        JVMMethodDescriptor::create(
+            {{"current", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::BOOLEAN)}},
+            JVMFieldDescriptor::createFundamental(codegen::FundamentalType::BOOLEAN)
+        )
     );
 
     AdaUtilityReadInt = AdaUtility->addMethod(
         "readInt",
-        JVMMethodDescriptor::createVoidRetun({
-            {"atomic", JVMFieldDescriptor::createObject(AtomicInteger->name())},
-        })
+        JVMMethodDescriptor::create(
+            {{"current", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::INT)}},
+            JVMFieldDescriptor::createFundamental(codegen::FundamentalType::INT)
+        )
     );
 
     AdaUtilityReadChar = AdaUtility->addMethod(
         "readChar",
-        JVMMethodDescriptor::createVoidRetun({
-            {"atomic", JVMFieldDescriptor::createObject(AtomicInteger->name())},
-        })
+        JVMMethodDescriptor::create(
+            {{"current", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::CHAR)}},
+            JVMFieldDescriptor::createFundamental(codegen::FundamentalType::CHAR)
+        )
     );
 
     AdaUtilityReadFloat = AdaUtility->addMethod(
         "readFloat",
-        JVMMethodDescriptor::createVoidRetun({
-            {"atomic", JVMFieldDescriptor::createObject(AtomicReference->name())},
-        })
+        JVMMethodDescriptor::create(
+            {{"current", JVMFieldDescriptor::createFundamental(codegen::FundamentalType::FLOAT)}},
+            JVMFieldDescriptor::createFundamental(codegen::FundamentalType::FLOAT)
+        )
     );
 
     AdaUtilityReadString = AdaUtility->addMethod(
         "readString",
         JVMMethodDescriptor::createVoidRetun({
-            {"atomic", JVMFieldDescriptor::createObject(StringBuiler->name())},
+            {"target", chars},
         })
     );
 }
@@ -9,44 +9,24 @@ void gen(std::vector<std::shared_ptr<mdl::Module>>& program);
 
 // prikols
 extern jvm_class::SharedPtrJVMClass InnerSubprograms;
-extern jvm_class::SharedPtrJVMClass StringBuiler;
 extern jvm_class::SharedPtrJVMClass PrintStream; 
-extern jvm_class::SharedPtrJVMClass AtomicInteger;
 extern jvm_class::SharedPtrJVMClass AdaUtility; 
 extern jvm_class::SharedPtrJVMClass JavaObject; 
 extern jvm_class::SharedPtrJVMClass JavaString; 
+extern jvm_class::SharedPtrJVMClass JavaSystem; 
+extern jvm_class::SharedPtrJVMClass JavaIndexException; 
 
 // init 
-extern class_member::SharedPtrMethod AdaUtilityInitArrayElements;
 extern class_member::SharedPtrMethod AdaUtilityJavaObjectInit;
-extern class_member::SharedPtrMethod AdaUtilityStringBuilderInit;
 
-// copy
-extern class_member::SharedPtrMethod AdaUtilityDeepCopy;
-extern class_member::SharedPtrMethod AdaUtilityDeepCopyArray;
-extern class_member::SharedPtrMethod AdaUtilityCopyStringBuilder;
+// copy: записи, массивы и строки копируются сгенерированными $copy
+extern class_member::SharedPtrMethod JavaSystemArraycopy;
 
-// atomic
-extern class_member::SharedPtrMethod AdaUtilityToAtomicBoolean;
-extern class_member::SharedPtrMethod AdaUtilityToAtomicInt;
-extern class_member::SharedPtrMethod AdaUtilityToAtomicFloat;
-extern class_member::SharedPtrMethod AdaUtilityToAtomicChar;
+// индекс многомерного массива вне диапазона измерения
+extern class_member::SharedPtrMethod JavaIndexExceptionInit;
 
-extern class_member::SharedPtrMethod AdaUtilityFromAtomicBoolean;
-extern class_member::SharedPtrMethod AdaUtilityFromAtomicInt;
-extern class_member::SharedPtrMethod AdaUtilityFromAtomicFloat;
-extern class_member::SharedPtrMethod AdaUtilityFromAtomicChar;
-
-extern class_member::SharedPtrMethod AdaUtilitySetAtomicBoolean;
-extern class_member::SharedPtrMethod AdaUtilitySetAtomicInt;
-extern class_member::SharedPtrMethod AdaUtilitySetAtomicFloat;
-extern class_member::SharedPtrMethod AdaUtilitySetAtomicChar;
-
-// string builder
-extern class_member::SharedPtrMethod AdaUtilitySetCharAt;
-extern class_member::SharedPtrMethod AdaUtilityCharAt;
-extern class_member::SharedPtrMethod AdaUtilityConcat;
-extern class_member::SharedPtrMethod AdaUtilityFromStringLiteral;
+// string: char[], литералы - static final поля inner_subprograms
+extern class_member::SharedPtrMethod JavaStringToCharArray;
 
 // image
 extern class_member::SharedPtrMethod AdaUtilityImageFromChar;
@@ -55,7 +35,7 @@ extern class_member::SharedPtrMethod AdaUtilityImageFromBool;
 extern class_member::SharedPtrMethod AdaUtilityImageFromFloat;
 
 // io
-extern class_member::SharedPtrMethod AdaUtilityPrintStringBuilder;
+extern class_member::SharedPtrMethod AdaUtilityPrintString;
 
 extern class_member::SharedPtrMethod AdaUtilityReadBool;
 extern class_member::SharedPtrMethod AdaUtilityReadInt;
@@ -65,4 +45,7 @@ extern class_member::SharedPtrMethod AdaUtilityReadString;
 
 void initAdaUtilityNames();
 
+// байты java/AdaUtility.class (ada_utility_class.cpp генерирует CMake)
+std::span<const std::byte> adaUtilityClass();
+
 } // namespace codegen
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "alloc_stats.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace alloc_stats {
+
+namespace {
+
+// у потока свой слот в своей кэш-линии: без гонок за общий счетчик;
+// потоков больше slotCount - слоты делятся, счет остается точным
+struct alignas(64) Slot {
+    std::atomic<std::size_t> count = 0;
+    std::atomic<std::size_t> bytes = 0;
+};
+
+constexpr std::size_t slotCount = 64;
+Slot slots_[slotCount];
+std::atomic<std::size_t> nextSlot_ = 0;
+std::atomic<bool> enabled_ = false;
+
+// тривиальный thread_local: operator new не может 
+// зависеть от конструкторов и деструкторов потока
+thread_local Slot* slot_ = nullptr;
+
+void count(std::size_t size) noexcept {
+    if (!enabled_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (!slot_) {
+        slot_ = &slots_[
+            nextSlot_.fetch_add(1, std::memory_order_relaxed) % slotCount];
+    }
+    slot_->count.fetch_add(1, std::memory_order_relaxed);
+    slot_->bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+} // namespace
+
+Snapshot snapshot() noexcept {
+    Snapshot res;
+    for (auto&& s : slots_) {
+        res.count += s.count.load(std::memory_order_relaxed);
+        res.bytes += s.bytes.load(std::memory_order_relaxed);
+    }
+    return res;
+}
+
+void setEnabled(bool enabled) noexcept {
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+} // namespace alloc_stats
+
+// замена глобального operator new; new[], nothrow варианты
+// и выровненные (через aligned_alloc) остаются стандартными,
+// первые два идут сюда же
+void* operator new(std::size_t size) {
+    alloc_stats::count(size);
+    if (auto p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+
+namespace alloc_stats {
+
+// счетчики глобального operator new, сумма по всем потокам;
+// считается только после setEnabled(true) (--time-passes)
+struct Snapshot {
+    std::size_t count = 0;
+    std::size_t bytes = 0;
+};
+
+Snapshot snapshot() noexcept;
+
+void setEnabled(bool enabled) noexcept;
+
+} // namespace alloc_stats
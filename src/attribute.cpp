@@ -1,15 +1,103 @@
 #include "attribute.hpp"
 
+#include <array>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
 
 namespace attribute {
+
+// Symbol
+namespace {
+
+// строки лежат в блоках по chunkSize и не перемещаются, поэтому 
+// string_view в ключах и ссылки из str() остаются валидными.
+// модули разбираются параллельно: intern под rw-локом, str без лока -
+// id виден потоку только после записи его строки (через тот же лок
+// или через передачу Symbol), а блок после создания не меняется
+struct SymbolTable {
+    static constexpr std::uint32_t chunkBits = 12;
+    static constexpr std::uint32_t chunkSize = 1u << chunkBits;
+    static constexpr std::uint32_t maxChunks = 4096;
+
+    SymbolTable() {
+        intern("");
+    }
+
+    std::uint32_t intern(std::string_view str) {
+        {
+            std::shared_lock lock(mtx);
+            if (auto it = ids.find(str); it != ids.end()) {
+                return it->second;
+            }
+        }
+        std::unique_lock lock(mtx);
+        if (auto it = ids.find(str); it != ids.end()) {
+            return it->second;
+        }
+        auto id = size;
+        if (id >> chunkBits >= maxChunks) {
+            throw std::length_error("Too many identifiers");
+        }
+        auto&& chunk = chunks[id >> chunkBits];
+        if (!chunk) {
+            chunk = std::make_unique<std::string[]>(chunkSize);
+        }
+        auto&& stored = chunk[id & (chunkSize - 1)];
+        stored = str;
+        ids.emplace(stored, id);
+        ++size;
+        return id;
+    }
+
+    const std::string& str(std::uint32_t id) const noexcept {
+        return chunks[id >> chunkBits][id & (chunkSize - 1)];
+    }
+
+    std::array<std::unique_ptr<std::string[]>, maxChunks> chunks;
+    std::uint32_t size = 0;
+    std::unordered_map<std::string_view, std::uint32_t> ids;
+    std::shared_mutex mtx;
+};
+
+SymbolTable& symbolTable() {
+    static SymbolTable table;
+    return table;
+}
+
+} // namespace
+
+Symbol::Symbol(const std::string& str) :
+    id_(symbolTable().intern(str))
+{}
+
+Symbol::Symbol(const char* str) :
+    id_(symbolTable().intern(str))
+{}
+
+const std::string& Symbol::str() const noexcept {
+    return symbolTable().str(id_);
+}
+
 // QualifiedName
-QualifiedName::QualifiedName(const std::string& base) :
+QualifiedName::QualifiedName(const Symbol& base) :
     fullName_({base})
 {}
 
-void QualifiedName::push(const std::string& name) {
+QualifiedName::QualifiedName(const std::string& base) :
+    fullName_({Symbol(base)})
+{}
+
+QualifiedName::QualifiedName(const char* base) :
+    fullName_({Symbol(base)})
+{}
+
+void QualifiedName::push(const Symbol& name) {
     fullName_.push_back(name); 
 }
 
@@ -30,10 +118,10 @@ std::string QualifiedName::toString(char delim) const {
     return ss.str();
 }
 
-const std::string& QualifiedName::first() const noexcept {
+const Symbol& QualifiedName::first() const noexcept {
     return fullName_.front();
 }
-const std::string& QualifiedName::last() const noexcept {
+const Symbol& QualifiedName::last() const noexcept {
     return fullName_.back();
 }
 
@@ -41,12 +129,12 @@ std::size_t QualifiedName::size() const noexcept {
     return fullName_.size();
 }
 
-std::vector<std::string>::const_iterator 
+QualifiedName::const_iterator 
 QualifiedName::begin() const {
     return fullName_.cbegin();
 }
 
-std::vector<std::string>::const_iterator 
+QualifiedName::const_iterator 
 QualifiedName::end() const {
     return fullName_.cend();
 }
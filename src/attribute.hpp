@@ -1,33 +1,92 @@
 #pragma once
 
+#include <compare>
+#include <cstdint>
+#include <functional>
+#include <ostream>
 #include <string>
 #include <vector>
 #include <initializer_list>
 
 namespace attribute {
+
+// интернированный идентификатор: номер строки в глобальной таблице,
+// копирование и == - как у int
+class Symbol {
+public:
+    Symbol() = default; // пустая строка
+    Symbol(const std::string& str);
+    Symbol(const char* str);
+
+public:
+    const std::string& str() const noexcept;
+    operator const std::string&() const noexcept { return str(); }
+    std::uint32_t id() const noexcept { return id_; }
+    bool empty() const noexcept { return !id_; }
+
+    friend bool operator==(Symbol lhs, Symbol rhs) noexcept {
+        return lhs.id_ == rhs.id_;
+    }
+    friend bool operator==(const Symbol& lhs, const std::string& rhs) {
+        return lhs.str() == rhs;
+    }
+    friend bool operator==(const Symbol& lhs, const char* rhs) {
+        return lhs.str() == rhs;
+    }
+    // порядок - по строкам, чтобы обход map не зависел
+    // от порядка интернирования
+    friend std::strong_ordering operator<=>(
+        const Symbol& lhs, const Symbol& rhs) 
+    {
+        return lhs.str() <=> rhs.str();
+    }
+
+    friend std::string operator+(const std::string& lhs, const Symbol& rhs) {
+        return lhs + rhs.str();
+    }
+    friend std::string operator+(const Symbol& lhs, const std::string& rhs) {
+        return lhs.str() + rhs;
+    }
+    friend std::string operator+(const char* lhs, const Symbol& rhs) {
+        return lhs + rhs.str();
+    }
+    friend std::string operator+(const Symbol& lhs, const char* rhs) {
+        return lhs.str() + rhs;
+    }
+    friend std::ostream& operator<<(std::ostream& out, const Symbol& s) {
+        return out << s.str();
+    }
+
+private:
+    std::uint32_t id_ = 0;
+};
     
 class QualifiedName {
 public:
+    using const_iterator = std::vector<Symbol>::const_iterator;
+
     QualifiedName() = default;
+    QualifiedName(const Symbol& base);
     QualifiedName(const std::string& base);
-    QualifiedName(std::initializer_list<std::string> list) :
+    QualifiedName(const char* base);
+    QualifiedName(std::initializer_list<Symbol> list) :
         fullName_(list)
     {}
 
 public:
-    void push(const std::string& name);
+    void push(const Symbol& name);
     bool empty() const noexcept; 
     std::string toString(char delim = '/') const;
-    const std::string& first() const noexcept; 
-    const std::string& last() const noexcept;
+    const Symbol& first() const noexcept; 
+    const Symbol& last() const noexcept;
     std::size_t size() const noexcept;
-    std::vector<std::string>::const_iterator begin() const;
-    std::vector<std::string>::const_iterator end() const;
+    const_iterator begin() const;
+    const_iterator end() const;
     void clear();
     
     auto operator<=>(const QualifiedName&) const = default;
 private:
-    std::vector<std::string> fullName_;
+    std::vector<Symbol> fullName_;
 };
 
 class Attribute {
@@ -47,3 +106,10 @@ private:
 
 } // namespace attribute
 
+template <>
+struct std::hash<attribute::Symbol> {
+    std::size_t operator()(const attribute::Symbol& s) const noexcept {
+        return s.id();
+    }
+};
+
@@ -1,66 +1,50 @@
 #include "basic_block.hpp"
 
+#include <algorithm>
+#include <array>
 #include <limits>
 #include <cmath>
+#include <stdexcept>
 
 namespace {
-std::uint16_t opStackSize(instr::OpCode op) {
-    using O = instr::OpCode;
-
-    switch (op) {
-        case O::iconst_m1: case O::iconst_0: case O::iconst_1:
-        case O::iconst_2:  case O::iconst_3: case O::iconst_4:
-        case O::iconst_5:  case O::fconst_0: case O::fconst_1:
-        case O::fconst_2:  case O::aconst_null:
-            return 1;
-
-        case O::lconst_0: case O::lconst_1:
-        case O::dconst_0: case O::dconst_1:
-            return 2;  
-
-        case O::iload: case O::iload_0: case O::iload_1:
-        case O::iload_2: case O::iload_3:
-        case O::fload: case O::fload_0: case O::fload_1:
-        case O::fload_2: case O::fload_3:
-        case O::aload: case O::aload_0: case O::aload_1:
-        case O::aload_2: case O::aload_3:
-            return 1;
-
-        case O::lload: case O::lload_0: case O::lload_1:
-        case O::lload_2: case O::lload_3:
-        case O::dload: case O::dload_0: case O::dload_1:
-        case O::dload_2: case O::dload_3:
-            return 2;
-
-        case O::getstatic:
-            return 2;
-
-        case O::getfield:
-            return 2;
-
-        case O::new_:
-            return 1;
-
-        case O::dup:
-            return 1;
-
-        case O::dup2: case O::dup2_x1:
-            return 2;
-
-        case O::invokevirtual:
-        case O::invokespecial:
-        case O::invokestatic:
-        case O::invokeinterface:
-            return 2;
-
-        case O::ldc: case O::ldc_w: 
-            return 1;
-        case O::ldc2_w:
-            return 2;
-
-        default:
-            return 0;
+
+constexpr std::uint32_t farCondLen = 3 + 5; // if<!cond> +8; goto_w
+
+bool isWide(instr::OpCode op) {
+    return instr::OpCode::goto_w == op || 
+           instr::OpCode::jsr_w == op;
+}
+
+std::uint32_t branchLen(const instr::Instr& i) {
+    auto op = i.opCode();
+    if (isWide(op)) {
+        return 5;
+    }
+    if (!i.far()) {
+        return 3;
+    }
+    return instr::invertBranch(op) ? farCondLen : 5;
+}
+
+bool fitsShort(std::int64_t offset) {
+    return std::numeric_limits<std::int16_t>::min() <= offset &&
+           offset <= std::numeric_limits<std::int16_t>::max();
+}
+
+// op и смещение перехода (2 или 4 байта, big-endian)
+void printBranch(utility::ByteSink& out, 
+                 instr::OpCode op, 
+                 std::int32_t offset, 
+                 bool wide)
+{
+    std::array<char, 5> buf;
+    buf[0] = static_cast<char>(op);
+    auto bits = static_cast<std::uint32_t>(offset);
+    std::size_t n = wide ? 4 : 2;
+    for (std::size_t k = 0; k < n; ++k) {
+        buf[n - k] = static_cast<char>(bits >> (8 * k));
     }
+    out.write(buf.data(), 1 + n);
 }
 
 } // namespace
@@ -74,49 +58,54 @@ BasicBlock::BasicBlock(
     , code_(code)
 {}
 
-void BasicBlock::printBytes(std::ostream& out) const {
+void BasicBlock::printBytes(utility::ByteSink& out) const {
     int brIdx = 0;
     for (auto&& i : instrs_) {
-        if (!i->isBranch()) {
-            i->printBytes(out);
+        if (!i.isBranch()) {
+            i.printBytes(out);
         } else {
             auto&& bb = branches_[brIdx++];
             auto idxOld 
-                = static_cast<std::int64_t>(i->idx());
+                = static_cast<std::int64_t>(i.idx());
             auto offset = static_cast<std::int32_t>(
                 bb->startOpCodeIdx() - idxOld);
-            auto op = i->opCode();
-            auto insCp = *i;
-            if (instr::OpCode::goto_w == op ||
-                instr::OpCode::jsr_w == op)
-            {
-                insCp.pushFourBytes(offset);
+            auto op = i.opCode();
+            if (isWide(op)) {
+                printBranch(out, op, offset, true);
             } 
-            else 
+            else if (!i.far())
             {
-                if (std::abs(offset) >= 
-                    std::numeric_limits<std::uint16_t>::max())
-                {
+                if (!fitsShort(offset)) {
                     throw std::logic_error("For a four-byte opcode offset," 
                                            " an instruction that" 
                                            " accepts two bytes is used");
                 }
-                insCp.pushTwoBytes(
-                    static_cast<std::uint16_t>(offset));
+                printBranch(out, op, offset, false);
+            } 
+            else if (auto inv = instr::invertBranch(op)) 
+            {
+                // обход goto_w при невыполнении исходного условия
+                printBranch(out, *inv, farCondLen, false);
+                printBranch(out, instr::OpCode::goto_w, offset - 3, true);
+            }
+            else
+            {
+                auto wideOp = instr::OpCode::jsr == op ? 
+                    instr::OpCode::jsr_w : instr::OpCode::goto_w;
+                printBranch(out, wideOp, offset, true);
             }
-            insCp.printBytes(out); 
         }
     }
 }
 
 void BasicBlock::insertInstr(instr::Instr instr) {
-    instrs_.emplace_back(new instr::Instr(std::move(instr)));
+    instrs_.push_back(std::move(instr));
 }
 
 void BasicBlock::insertBranch(
     instr::OpCode op, bb::BasicBlock* to)
 {
-    instrs_.emplace_back(new instr::Instr(op, true));
+    instrs_.emplace_back(op, true);
     branches_.push_back(to);
 }
 
@@ -130,20 +119,8 @@ void BasicBlock::setStartOpCodeIdx(
 { 
     startOpCodeIdx_ = idx; 
     for (auto&& i : instrs_) {
-        i->setIdx(idx);
-        if (i->isBranch()) {
-            if (i->opCode() == instr::OpCode::goto_w ||
-                i->opCode() == instr::OpCode::jsr_w) 
-            {
-                idx += 5;
-            } 
-            else 
-            {
-                idx += 3;
-            }
-        } else {
-            idx += i->len();
-        }
+        i.setIdx(idx);
+        idx += i.isBranch() ? branchLen(i) : i.len();
     }
 }
 
@@ -152,34 +129,63 @@ BasicBlock::codeAttr() {
     return code_;
 }
 
+int BasicBlock::id() const noexcept {
+    return id_;
+}
+
 std::uint32_t BasicBlock::len() const {
     std::uint32_t len = 0;
     for (auto&& i : instrs_) {
-        if (i->isBranch()) {
-            if (i->opCode() == instr::OpCode::goto_w ||
-                i->opCode() == instr::OpCode::jsr_w) 
-            {
-                len += 5;
-            } 
-            else 
-            {
-                len += 3;
-            }
-        } else {
-            len += i->len();
-        }
+        len += i.isBranch() ? branchLen(i) : i.len();
     }
     return len;
 }
 
-std::uint16_t BasicBlock::stackSize() const {
-    std::uint16_t stack = 0;
+bool BasicBlock::relaxBranches() {
+    bool changed = false;
+    int brIdx = 0;
+    for (auto&& i : instrs_) {
+        if (!i.isBranch()) {
+            continue;
+        }
+        auto&& bb = branches_[brIdx++];
+        if (i.far() || isWide(i.opCode())) {
+            continue;
+        }
+        auto offset = 
+            static_cast<std::int64_t>(bb->startOpCodeIdx()) - i.idx();
+        if (!fitsShort(offset)) {
+            i.setFar();
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+std::uint16_t BasicBlock::stackSize(
+    std::int32_t& depth,
+    std::vector<std::pair<BasicBlock*, std::int32_t>>& succ) const
+{
+    auto max = depth;
+    int brIdx = 0;
     for (auto&& i : instrs_) {
-        if (i) {
-            stack += opStackSize(i->opCode());
+        auto [pop, push] = i.stackEffect();
+        depth = std::max(depth - pop, 0) + push;
+        max = std::max(max, depth);
+        if (i.isBranch()) {
+            succ.emplace_back(branches_[brIdx++], depth);
         }
-    } 
-    return stack;
+    }
+    if (max > std::numeric_limits<std::uint16_t>::max()) {
+        throw std::logic_error("Operand stack depth" 
+                               " exceeds 65535");
+    }
+    return static_cast<std::uint16_t>(max);
+}
+
+bool BasicBlock::fallsThrough() const {
+    return instrs_.empty() || 
+        !instr::breaksFlow(instrs_.back().opCode());
 }
 
 } // namespace bb
\ No newline at end of file
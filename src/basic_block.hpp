@@ -9,20 +9,27 @@ namespace jvm_attribute {
     class CodeAttr;
 }
 
+namespace peephole {
+    class Code;
+}
+
 namespace bb {
 
 class BasicBlock {
 public:
     friend class jvm_attribute::CodeAttr;
+    friend class peephole::Code;
 
     std::uint32_t startOpCodeIdx() const noexcept;
+    // порядковый номер в методе
+    int id() const noexcept;
     
 private:
     BasicBlock(
         int id, 
         std::weak_ptr<jvm_attribute::CodeAttr> code);
 
-    void printBytes(std::ostream& out) const;
+    void printBytes(utility::ByteSink& out) const;
 
     void insertInstr(instr::Instr instr);
     void insertBranch(instr::OpCode op, bb::BasicBlock* to); 
@@ -32,14 +39,21 @@ private:
     std::weak_ptr<jvm_attribute::CodeAttr> codeAttr();
 
     std::uint32_t len() const;
-    std::uint16_t stackSize() const;
-    
-    int id() const noexcept;
+    // помечает far переходы, не достающие до цели при текущих
+    // адресах; true, если что-то изменилось (длина bb выросла)
+    bool relaxBranches();
+    // depth: на входе - глубина стека в начале bb, на выходе - в конце;
+    // в succ пишутся цели переходов с глубиной стека на них
+    std::uint16_t stackSize(
+        std::int32_t& depth,
+        std::vector<std::pair<BasicBlock*, std::int32_t>>& succ) const;
+    // false, если bb заканчивается goto, return или athrow
+    bool fallsThrough() const;
 
 private:
     int id_;
     std::uint32_t startOpCodeIdx_;
-    std::vector<std::unique_ptr<instr::Instr>> instrs_;
+    std::vector<instr::Instr> instrs_;
     std::weak_ptr<jvm_attribute::CodeAttr> code_; 
     std::vector<bb::BasicBlock*> branches_;
 };
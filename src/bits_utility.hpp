@@ -1,29 +1,48 @@
 #pragma once
 
-#include <ostream>
-
+#include <bit>
 #include <concepts>
+#include <cstddef>
+#include <string_view>
+#include <vector>
 
 namespace utility {
 
-template <std::integral Integral>
-void printBytes(std::ostream& out, Integral v) {
-    out.write(
-        reinterpret_cast<char*>(&v),
-        sizeof(Integral)
-    );
-}
-
-template <std::integral Integral>
-Integral reverse(Integral x) {
-    Integral res = 0;
-    Integral mask = 0xff;
-    for (std::uint64_t i = 0; i < sizeof(Integral); ++i) {
-        res <<= 8;
-        res |= x & mask;
-        x >>= 8;
+// буфер class-файла в памяти: целые пишутся в big-endian,
+// в файл он записывается целиком одним write
+class ByteSink {
+public:
+    template <std::integral Integral>
+    void put(Integral v) {
+        if constexpr (std::endian::little == std::endian::native) {
+            v = std::byteswap(v);
+        }
+        write(&v, sizeof(v));
+    }
+
+    void write(const void* data, std::size_t len) {
+        auto* p = static_cast<const std::byte*>(data);
+        bytes_.insert(bytes_.end(), p, p + len);
+    }
+
+    void write(std::string_view str) {
+        write(str.data(), str.size());
+    }
+
+    std::size_t size() const noexcept {
+        return bytes_.size();
+    }
+
+    const std::vector<std::byte>& bytes() const noexcept {
+        return bytes_;
     }
-    return res;
-}
 
-} // namespace utility
\ No newline at end of file
+    std::vector<std::byte> release() noexcept {
+        return std::move(bytes_);
+    }
+
+private:
+    std::vector<std::byte> bytes_;
+};
+
+} // namespace utility
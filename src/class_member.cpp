@@ -6,21 +6,17 @@
 
 namespace class_member {
 
-void IJVMClassMember::printBytes(std::ostream& out) const {
+void IJVMClassMember::printBytes(utility::ByteSink& out) const {
     auto flags 
         = static_cast<std::uint16_t>(accf_);
-    utility::printBytes(out, 
-        utility::reverse(flags));
+    out.put(flags);
 
-    utility::printBytes(out, 
-        utility::reverse(name_));
-    utility::printBytes(out, 
-        utility::reverse(desc_));
+    out.put(name_);
+    out.put(desc_);
 
     auto sz 
         = static_cast<std::uint16_t>(attrs_.size());
-    utility::printBytes(out, 
-        utility::reverse(sz));
+    out.put(sz);
 
     for (auto&& attr : attrs_) {
         attr->printBytes(out);
@@ -113,4 +109,17 @@ IJVMClassMember::IJVMClassMember(
     , cp_(cp)
 {}
 
+void IJVMClassMember::rebind_(
+    std::uint16_t name, 
+    std::uint16_t desc,
+    constant_pool::SharedPtrJVMCP cp)
+{
+    name_ = name;
+    desc_ = desc;
+    cp_ = cp;
+    for (auto&& attr : attrs_) {
+        attr->setPool(cp);
+    }
+}
+
 } // namespace class_members 
\ No newline at end of file
@@ -15,7 +15,7 @@ class IJVMClassMember {
         std::shared_ptr<jvm_attribute::IAttribute>;
 
 public:
-    void printBytes(std::ostream& out) const;
+    void printBytes(utility::ByteSink& out) const;
 
 public: 
     void addFlag(codegen::AccessFlag flag);
@@ -35,6 +35,13 @@ protected:
         constant_pool::SharedPtrJVMCP cp
     ); 
 
+    // член переезжает в другой класс: индексы и атрибуты 
+    // пересчитываются для его constant pool
+    void rebind_(
+        std::uint16_t name, 
+        std::uint16_t desc,
+        constant_pool::SharedPtrJVMCP cp);
+
 private:
     // byte structure
     std::uint16_t accf_ = 0;
@@ -1,6 +1,7 @@
 #include "codegen.hpp"
 
 #include <fstream>
+#include <limits>
 
 namespace codegen::java_bytecode_codegen {
 
@@ -9,17 +10,134 @@ JavaBCCodegen::JavaBCCodegen(
     std::uint16_t minorV) :
     majorV_(majorV)
     , minorV_(minorV)
-{}
+{
+    peephole::addDefaultRules(peephole_);
+}
+
+namespace {
+
+constexpr std::size_t constPoolLimit = 
+    std::numeric_limits<std::uint16_t>::max();
+// запас constant pool на код одного метода
+constexpr std::size_t methodReserve = 8192;
+
+bool canSplit(const class_member::JVMClassMethod& method) {
+    auto&& name = method.methodName();
+    return method.isStatic() && 
+        "main" != name && "<clinit>" != name && "<init>" != name;
+}
+
+} // namespace
 
 void JavaBCCodegen::printClass( 
-    jvm_class::SharedPtrJVMClass cls) const 
+    jvm_class::SharedPtrJVMClass cls) 
+{
+    if (jar_) {
+        jar_->add(cls->name() + ".class", classBytes(cls));
+    } else {
+        std::fstream f(cls->simpleName() + ".class", 
+            std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!f.is_open()) {
+            throw std::runtime_error("The file cannot be opened");
+        }
+        auto bytes = classBytes(cls);
+        f.write(reinterpret_cast<const char*>(bytes.data()), 
+                static_cast<std::streamsize>(bytes.size()));
+    }
+
+    if (auto it = splits_.find(cls.get()); it != splits_.end()) {
+        for (auto&& split : it->second) {
+            printClass(split);
+        }
+    }
+}
+
+std::vector<std::byte> JavaBCCodegen::classBytes(
+    jvm_class::SharedPtrJVMClass cls)
+{
+    if (peephole_.enabled()) {
+        cls->optimize(peephole_);
+    }
+    cls->finalize();
+    return cls->bytes();
+}
+
+void JavaBCCodegen::setJarOutput(
+    const std::filesystem::path& path, 
+    jar::Compression compression)
+{
+    jar_ = std::make_unique<jar::JarWriter>(compression);
+    jarPath_ = path;
+}
+
+void JavaBCCodegen::addJarResource(
+    const std::string& path, 
+    std::span<const std::byte> data)
+{
+    if (jar_) {
+        jar_->add(path, data);
+    }
+}
+
+void JavaBCCodegen::finishOutput(
+    jvm_class::SharedPtrJVMClass mainClass)
+{
+    if (!jar_) {
+        return;
+    }
+    jar_->setMainClass(mainClass->name());
+    jar_->write(jarPath_);
+}
+
+peephole::Peephole& JavaBCCodegen::peephole() noexcept {
+    return peephole_;
+}
+
+void JavaBCCodegen::printConstPoolStats(std::ostream& out) const {
+    out << "constant pool:\n";
+    std::size_t entries = 0, hits = 0, bytes = 0;
+    for (auto&& cls : clss_) {
+        auto&& cp = cls->cp();
+        utility::ByteSink sink;
+        cp->printBytes(sink);
+        out << "  " << cls->name() << ": " << cp->size() - 1 
+            << " entries, " << sink.size() << " bytes, "
+            << cp->dedupHits() << " deduplicated\n";
+        entries += cp->size() - 1;
+        hits += cp->dedupHits();
+        bytes += sink.size();
+    }
+    out << "  total: " << entries << " entries, " << bytes 
+        << " bytes, " << hits << " deduplicated\n";
+}
+
+void JavaBCCodegen::ensureConstPoolRoom(
+    class_member::SharedPtrMethod method)
 {
-    std::fstream f(cls->simpleName() + ".class", 
-        std::ios::out | std::ios::trunc);
-    if (!f.is_open()) {
-        throw std::runtime_error("The file cannot be opened");
+    auto cls = method->cls();
+    if (!canSplit(*method)) {
+        return;
+    }
+    // в cls еще могут понадобиться переходники 
+    // для всех его методов (по паре записей)
+    auto used = cls->cp()->size() + 2 * cls->methodCount();
+    if (used + methodReserve < constPoolLimit) {
+        return;
+    }
+
+    auto&& splits = splits_[cls.get()];
+    if (splits.empty() || 
+        splits.back()->cp()->size() + methodReserve >= constPoolLimit)
+    {
+        auto split = createClass(
+            cls->simpleName() + "$" + std::to_string(splits.size() + 1));
+        if (auto parent = cls->parent().lock()) {
+            split->setParent(parent);
+        }
+        split->addAccesFlag(AccessFlag::ACC_PUBLIC);
+        splits.push_back(split);
     }
-    cls->printBytes(f);
+    cls->moveMethod(method, splits.back());
 }
 
 jvm_class::SharedPtrJVMClass 
@@ -7,8 +7,11 @@
 #include <string>
 #include <ostream>
 #include <memory>
+#include <map>
 
 #include "jvm_class.hpp"
+#include "peephole.hpp"
+#include "jar_writer.hpp"
 
 namespace codegen {
 
@@ -22,13 +25,41 @@ public:
 
 public:
     void printClass( // -> cls_name.class file 
-        jvm_class::SharedPtrJVMClass cls) const;
+        jvm_class::SharedPtrJVMClass cls);
+    // то же, что пишет printClass, но в память
+    std::vector<std::byte> classBytes(
+        jvm_class::SharedPtrJVMClass cls);
+
+    // printClass складывает классы в один jar вместо .class файлов
+    void setJarOutput(const std::filesystem::path& path, 
+                      jar::Compression compression);
+    // записывает jar (если задан) с Main-Class mainClass
+    void finishOutput(jvm_class::SharedPtrJVMClass mainClass);
+    // готовый класс в jar (например, AdaUtility.class); без jar - ничего
+    void addJarResource(const std::string& path, 
+                        std::span<const std::byte> data);
 
     jvm_class::SharedPtrJVMClass createClass(
         const attribute::QualifiedName& name);
+
+    // вызывается перед генерацией кода статического метода:
+    // если его коду может не хватить constant pool класса, 
+    // метод переносится в дополнительный класс cls$N, 
+    // который printClass(cls) запишет вместе с cls
+    void ensureConstPoolRoom(class_member::SharedPtrMethod method);
+
+    // применяется к методам в printClass
+    peephole::Peephole& peephole() noexcept;
+    // размеры constant pool созданных классов
+    void printConstPoolStats(std::ostream& out) const;
     
 private:
     std::vector<jvm_class::SharedPtrJVMClass> clss_;
+    std::map<jvm_class::JVMClass*, 
+        std::vector<jvm_class::SharedPtrJVMClass>> splits_;
+    peephole::Peephole peephole_;
+    std::unique_ptr<jar::JarWriter> jar_;
+    std::filesystem::path jarPath_;
     std::uint16_t majorV_;
     std::uint16_t minorV_;
 };
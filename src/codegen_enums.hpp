@@ -38,6 +38,11 @@ enum class ArrayType : std::uint8_t {
     LONG	= 11,
 };
 
+enum class LayoutMode {
+    EAGER,      // пересчет адресов bb после каждой инструкции
+    DEFERRED    // один пересчет в finalize перед printBytes
+};
+
 } // namespace java_bytecode_codegen  
 
 } // namespace codegen
\ No newline at end of file
@@ -9,9 +9,9 @@ namespace constant {
 //IConstant
 IConstant::IConstant(ConstantType type) : type_(type) {}
 
-void IConstant::printBytes(std::ostream& out) const {
+void IConstant::printBytes(utility::ByteSink& out) const {
     auto i = static_cast<std::uint8_t>(type_);
-    utility::printBytes(out,  i);
+    out.put(i);
 }
 
 // Utf8
@@ -20,11 +20,10 @@ Utf8::Utf8(const std::string& text) :
     , text_(text)
 {}
 
-void Utf8::printBytes(std::ostream& out) const {
+void Utf8::printBytes(utility::ByteSink& out) const {
     IConstant::printBytes(out);
-    utility::printBytes(out, utility::reverse(
-        static_cast<std::uint16_t>(text_.length())));
-    out << text_;
+    out.put(static_cast<std::uint16_t>(text_.length()));
+    out.write(text_);
 }
 
 // Integer 
@@ -33,10 +32,9 @@ Integer::Integer(int numb) :
     , numb_(numb)
 {}
 
-void Integer::printBytes(std::ostream& out) const {
+void Integer::printBytes(utility::ByteSink& out) const {
     IConstant::printBytes(out);
-    utility::printBytes(out, 
-        utility::reverse(numb_));
+    out.put(numb_);
 }
 
 // Long
@@ -45,10 +43,9 @@ Long::Long(std::int64_t numb) :
     , numb_(numb)
 {}
 
-void Long::printBytes(std::ostream& out) const {
+void Long::printBytes(utility::ByteSink& out) const {
     IConstant::printBytes(out);
-    utility::printBytes(out, 
-        utility::reverse(numb_));
+    out.put(numb_);
 }
 
 // Float
@@ -57,10 +54,9 @@ Float::Float(float numb) :
     , f_(numb)
 {}
 
-void Float::printBytes(std::ostream& out) const {
+void Float::printBytes(utility::ByteSink& out) const {
     IConstant::printBytes(out);
-    utility::printBytes(out, 
-        utility::reverse(i_));
+    out.put(i_);
 }
 
 // Double
@@ -69,10 +65,9 @@ Double::Double(double numb) :
     , f_(numb)
 {}
 
-void Double::printBytes(std::ostream& out) const {
+void Double::printBytes(utility::ByteSink& out) const {
     IConstant::printBytes(out);
-    utility::printBytes(out, 
-        utility::reverse(i_));
+    out.put(i_);
 }
 
 // String
@@ -81,10 +76,9 @@ String::String(std::uint16_t utf8) :
     , utf8_(utf8)
 {}
 
-void String::printBytes(std::ostream& out) const {
+void String::printBytes(utility::ByteSink& out) const {
     IConstant::printBytes(out);
-    utility::printBytes(out, 
-        utility::reverse(utf8_));
+    out.put(utf8_);
 }
 
 // NameAndType
@@ -95,12 +89,10 @@ NameAndType::NameAndType(std::uint16_t name,
     , descr_(descr)
 {}
 
-void NameAndType::printBytes(std::ostream& out) const {
+void NameAndType::printBytes(utility::ByteSink& out) const {
     IConstant::printBytes(out);
-    utility::printBytes(out, 
-        utility::reverse(name_));    
-    utility::printBytes(out, 
-        utility::reverse(descr_));
+    out.put(name_);    
+    out.put(descr_);
 }
 
 // Class
@@ -109,10 +101,9 @@ Class::Class(std::uint16_t name) :
     , name_(name)
 {}
 
-void Class::printBytes(std::ostream& out) const {
+void Class::printBytes(utility::ByteSink& out) const {
     IConstant::printBytes(out);
-    utility::printBytes(out, 
-        utility::reverse(name_));   
+    out.put(name_);   
 }
 
 // Fieldref
@@ -123,12 +114,10 @@ Fieldref::Fieldref(std::uint16_t cls,
     , nameNType_(nameNType)
 {}
 
-void Fieldref::printBytes(std::ostream& out) const {
+void Fieldref::printBytes(utility::ByteSink& out) const {
     IConstant::printBytes(out);
-    utility::printBytes(out, 
-        utility::reverse(class_));    
-    utility::printBytes(out, 
-        utility::reverse(nameNType_));
+    out.put(class_);    
+    out.put(nameNType_);
 }
 
 // Methodref
@@ -139,12 +128,10 @@ Methodref::Methodref(std::uint16_t cls,
     , nameNType_(nameNType)
 {}
 
-void Methodref::printBytes(std::ostream& out) const {
+void Methodref::printBytes(utility::ByteSink& out) const {
     IConstant::printBytes(out);
-    utility::printBytes(out, 
-        utility::reverse(class_));    
-    utility::printBytes(out, 
-        utility::reverse(nameNType_));
+    out.put(class_);    
+    out.put(nameNType_);
 }
 
 // Descriptor
@@ -160,7 +147,7 @@ Descriptor::Descriptor(std::unique_ptr<
     , methodType_(std::move(methodType))
 {}
 
-void Descriptor::printBytes(std::ostream& out) const {
+void Descriptor::printBytes(utility::ByteSink& out) const {
     IConstant::printBytes(out);
     const std::string* type = nullptr;
     if (fieldType_) {
@@ -170,9 +157,8 @@ void Descriptor::printBytes(std::ostream& out) const {
         type = &methodType_->toString();
     }
     assert(type);
-    utility::printBytes(out, utility::reverse(
-        static_cast<std::uint16_t>(type->length())));
-    out << *type;
+    out.put(static_cast<std::uint16_t>(type->length()));
+    out.write(*type);
 }
 
 } // namespace constant
\ No newline at end of file
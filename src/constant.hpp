@@ -6,6 +6,7 @@
 #include <memory>
 
 #include "descriptor.hpp"
+#include "bits_utility.hpp"
 
 namespace constant {
 
@@ -33,7 +34,7 @@ struct IConstant {
     virtual ~IConstant() = default;
 
 public:
-    virtual void printBytes(std::ostream& out) const = 0; 
+    virtual void printBytes(utility::ByteSink& out) const = 0; 
 
 protected:
     ConstantType type_; 
@@ -48,7 +49,7 @@ public:
     Utf8(const std::string& text);
 
 public: // IConstant interface
-    void printBytes(std::ostream& out) const override;
+    void printBytes(utility::ByteSink& out) const override;
 
 private:
     std::string text_;
@@ -59,7 +60,7 @@ public:
     Integer(int numb);
 
 public: // IConstant interface
-    void printBytes(std::ostream& out) const override;
+    void printBytes(utility::ByteSink& out) const override;
 
 private:
     int numb_;
@@ -70,7 +71,7 @@ public:
     Long(std::int64_t numb);
 
 public: // IConstant interface
-    void printBytes(std::ostream& out) const override;
+    void printBytes(utility::ByteSink& out) const override;
 
 private:
     std::int64_t numb_;
@@ -82,7 +83,7 @@ public:
     Float(float numb);
 
 public: // IConstant interface
-    void printBytes(std::ostream& out) const override;
+    void printBytes(utility::ByteSink& out) const override;
 
 private:
     union {
@@ -96,7 +97,7 @@ public:
     Double(double numb);
 
 public: // IConstant interface
-    void printBytes(std::ostream& out) const override;
+    void printBytes(utility::ByteSink& out) const override;
 
 private:
     union {
@@ -110,7 +111,7 @@ public:
     String(std::uint16_t utf8); // constant_pool idx
 
 public: // IConstant interface
-    void printBytes(std::ostream& out) const override;
+    void printBytes(utility::ByteSink& out) const override;
 
 private:
     std::uint16_t utf8_;
@@ -122,7 +123,7 @@ public:
     NameAndType(std::uint16_t name, std::uint16_t descr); 
 
 public: // IConstant interface
-    void printBytes(std::ostream& out) const override;
+    void printBytes(utility::ByteSink& out) const override;
 
 private:
     std::uint16_t name_;
@@ -134,7 +135,7 @@ public:
     Class(std::uint16_t name); // utf8 constant_pool idx
 
 public: // IConstant interface
-    void printBytes(std::ostream& out) const override;
+    void printBytes(utility::ByteSink& out) const override;
 
 private:
     std::uint16_t name_;
@@ -146,7 +147,7 @@ public:
     Fieldref(std::uint16_t cls, std::uint16_t nameNType); 
 
 public: // IConstant interface
-    void printBytes(std::ostream& out) const override;
+    void printBytes(utility::ByteSink& out) const override;
 
 private:    
     std::uint16_t class_;
@@ -159,7 +160,7 @@ public:
     Methodref(std::uint16_t cls, std::uint16_t nameNType); 
 
 public: // IConstant interface
-    void printBytes(std::ostream& out) const override;
+    void printBytes(utility::ByteSink& out) const override;
 
 private:    
     std::uint16_t class_;
@@ -174,7 +175,7 @@ public:
         descriptor::JVMMethodDescriptor> methodType);
 
 public: // IConstant interface
-    void printBytes(std::ostream& out) const override;
+    void printBytes(utility::ByteSink& out) const override;
 
 private:
     std::unique_ptr<
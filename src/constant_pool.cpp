@@ -1,215 +1,281 @@
 #include "constant_pool.hpp"
 
+#include <bit>
+#include <limits>
+#include <stdexcept>
+
 namespace constant_pool {
 
-JVMConstantPool::JVMConstantPool() : consts_(1) { 
+namespace {
+
+using constant::ConstantType;
+
+void appendBE(std::string&) {}
+
+template<class T, class... Ts>
+void appendBE(std::string& key, T v, Ts... rest) {
+    for (int sh = (sizeof(T) - 1) * 8; sh >= 0; sh -= 8) {
+        key.push_back(static_cast<char>(
+            static_cast<std::uint64_t>(v) >> sh & 0xff));
+    }
+    appendBE(key, rest...);
+}
+
+// ключ - тег и полезная нагрузка, как в class файле
+template<class... Ts>
+std::string makeKey(ConstantType tag, Ts... payload) {
+    std::string key(1, static_cast<char>(tag));
+    appendBE(key, payload...);
+    return key;
+}
+
+std::string makeKey(ConstantType tag, const std::string& text) {
+    std::string key(1, static_cast<char>(tag));
+    key += text;
+    return key;
+}
+
+// FNV-1a
+std::uint32_t hashKey(const std::string& key) {
+    std::uint32_t h = 2166136261u;
+    for (auto c : key) {
+        h ^= static_cast<std::uint8_t>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+std::pair<bool, std::uint16_t> found(std::uint16_t idx) {
+    return {0 != idx, idx};
+}
+
+} // namespace
+
+JVMConstantPool::JVMConstantPool() : consts_(1), keys_(1) {
     consts_[0].reset(nullptr);
+    rehash_(64);
 }
 
-std::uint16_t JVMConstantPool::addUtf8(const std::string& text) {
-    auto c = std::make_unique<constant::Utf8>(text);
+std::uint16_t JVMConstantPool::find_(
+    const std::string& key, std::uint32_t hash) const
+{
+    auto mask = table_.size() - 1;
+    for (auto i = hash & mask; table_[i].idx; i = (i + 1) & mask) {
+        if (table_[i].hash == hash && keys_[table_[i].idx] == key) {
+            return table_[i].idx;
+        }
+    }
+    return 0;
+}
+
+void JVMConstantPool::rehash_(std::size_t capacity) {
+    std::vector<Slot> old(capacity);
+    old.swap(table_);
+    auto mask = capacity - 1;
+    for (auto&& s : old) {
+        if (!s.idx) {
+            continue;
+        }
+        auto i = s.hash & mask;
+        while (table_[i].idx) {
+            i = (i + 1) & mask;
+        }
+        table_[i] = s;
+    }
+}
+
+// make вызывается, только если константы еще нет;
+// wide - long/double, за которыми идет пустой слот
+template<class Make>
+std::uint16_t JVMConstantPool::intern_(
+    std::string key, Make make, bool wide)
+{
+    auto hash = hashKey(key);
+    if (auto idx = find_(key, hash)) {
+        ++hits_;
+        return idx;
+    }
+
+    auto c = make();
+    auto idx = consts_.size();
+    if (idx + (wide ? 1 : 0) > std::numeric_limits<std::uint16_t>::max() - 1) {
+        throw std::runtime_error("Constant pool overflow");
+    }
     consts_.emplace_back(std::move(c));
-    int sz = static_cast<int>(consts_.size());
-    return static_cast<std::uint16_t>(sz - 1);
+    keys_.push_back(std::move(key));
+    if (wide) {
+        consts_.emplace_back(nullptr);
+        keys_.emplace_back();
+    }
+
+    // заполненность не больше 1/2
+    if (2 * (count_ + 1) > table_.size()) {
+        rehash_(2 * table_.size());
+    }
+    auto mask = table_.size() - 1;
+    auto i = hash & mask;
+    while (table_[i].idx) {
+        i = (i + 1) & mask;
+    }
+    table_[i] = {hash, static_cast<std::uint16_t>(idx)};
+    ++count_;
+    return static_cast<std::uint16_t>(idx);
+}
+
+std::uint16_t JVMConstantPool::addUtf8(const std::string& text) {
+    return intern_(makeKey(ConstantType::Utf8, text), [&] {
+        return std::make_unique<constant::Utf8>(text);
+    });
 }
 
 std::uint16_t JVMConstantPool::addInteger(int numb) {
-    if (intCnst_.contains(numb)) return intCnst_[numb];
-    auto c = std::make_unique<constant::Integer>(numb);
-    consts_.emplace_back(std::move(c));
-    int sz = static_cast<int>(consts_.size());
-    int idx = static_cast<std::uint16_t>(sz - 1);
-    intCnst_[numb] = idx;
-    return idx;
+    return intern_(makeKey(ConstantType::Integer, numb), [&] {
+        return std::make_unique<constant::Integer>(numb);
+    });
 }
 
 std::uint16_t JVMConstantPool::addFloat(float numb) {
-    if (floatCnst_.contains(numb)) return floatCnst_[numb];
-    auto c = std::make_unique<constant::Float>(numb);
-    consts_.emplace_back(std::move(c));
-    int sz = static_cast<int>(consts_.size());
-    int idx = static_cast<std::uint16_t>(sz - 1);
-    floatCnst_[numb] = idx;
-    return idx;
+    // по битам: 0.0 и -0.0 - разные константы
+    auto bits = std::bit_cast<std::uint32_t>(numb);
+    return intern_(makeKey(ConstantType::Float, bits), [&] {
+        return std::make_unique<constant::Float>(numb);
+    });
 }
 
 std::uint16_t JVMConstantPool::addDouble(double numb) {
-    if (doubleCnst_.contains(numb)) return doubleCnst_[numb];
-    auto c = std::make_unique<constant::Double>(numb);
-    consts_.emplace_back(std::move(c));
-    int sz = static_cast<int>(consts_.size());
-    int idx = static_cast<std::uint16_t>(sz - 1);
-    doubleCnst_[numb] = idx;
-    return idx;
+    auto bits = std::bit_cast<std::uint64_t>(numb);
+    return intern_(makeKey(ConstantType::Double, bits), [&] {
+        return std::make_unique<constant::Double>(numb);
+    }, true);
 }
 
 std::uint16_t JVMConstantPool::addLong(std::int64_t numb) {
-    if (longCnst_.contains(numb)) return longCnst_[numb];
-    auto c = std::make_unique<constant::Long>(numb);
-    consts_.emplace_back(std::move(c));
-    int sz = static_cast<int>(consts_.size());
-    int idx = static_cast<std::uint16_t>(sz - 1);
-    longCnst_[numb] = idx;
-    return idx;
+    return intern_(makeKey(ConstantType::Long, numb), [&] {
+        return std::make_unique<constant::Long>(numb);
+    }, true);
 }
 
 std::uint16_t JVMConstantPool::addString(const std::string& string) {
-    if (stringCnst_.contains(string)) return stringCnst_[string];
-    auto c = std::make_unique<constant::String>(
-        addUtf8(string));
-    consts_.emplace_back(std::move(c));
-    int sz = static_cast<int>(consts_.size());
-    int idx = static_cast<std::uint16_t>(sz - 1);
-    stringCnst_[string] = idx;
-    return idx;
+    auto utf8Idx = addUtf8(string);
+    return intern_(makeKey(ConstantType::String, utf8Idx), [&] {
+        return std::make_unique<constant::String>(utf8Idx);
+    });
 }
 
 std::uint16_t JVMConstantPool::addClass(
-    const std::string& name) 
-{   if (classesCnst_.contains(name)) return classesCnst_[name];
-    auto [ok, utf8Idx] = getUtf8NameIdx(name);
-    if (!ok) {
-        utf8Idx = addUtf8(name);
-    }
-    auto c = std::make_unique<constant::Class>(utf8Idx);
-    consts_.emplace_back(std::move(c));
-    int sz = static_cast<int>(consts_.size());
-    auto idx = static_cast<std::uint16_t>(sz - 1);
-    classesCnst_[name] = idx;
-    return idx;
+    const std::string& name)
+{
+    auto utf8Idx = addUtf8(name);
+    return intern_(makeKey(ConstantType::Class, utf8Idx), [&] {
+        return std::make_unique<constant::Class>(utf8Idx);
+    });
 }
 
 std::uint16_t JVMConstantPool::addFieldRef(
-    std::uint16_t cls, std::uint16_t nameNType) 
+    std::uint16_t cls, std::uint16_t nameNType)
 {
-    auto c = 
-        std::make_unique<constant::Fieldref>(cls, nameNType);
-    consts_.emplace_back(std::move(c));
-    int sz = static_cast<int>(consts_.size());
-    return static_cast<std::uint16_t>(sz - 1);
+    return intern_(
+        makeKey(ConstantType::Fieldref, cls, nameNType), [&] {
+        return std::make_unique<constant::Fieldref>(cls, nameNType);
+    });
 }
 
 std::uint16_t JVMConstantPool::addMehodRef(
-    std::uint16_t cls, std::uint16_t nameNType) 
+    std::uint16_t cls, std::uint16_t nameNType)
 {
-    auto c = 
-        std::make_unique<constant::Methodref>(cls, nameNType);
-    consts_.emplace_back(std::move(c));
-    int sz = static_cast<int>(consts_.size());
-    return static_cast<std::uint16_t>(sz - 1);
+    return intern_(
+        makeKey(ConstantType::Methodref, cls, nameNType), [&] {
+        return std::make_unique<constant::Methodref>(cls, nameNType);
+    });
 }
 
 std::uint16_t JVMConstantPool::addNameAndType(
-    std::uint16_t name, std::uint16_t descr) 
+    std::uint16_t name, std::uint16_t descr)
 {
-    auto c = 
-        std::make_unique<constant::NameAndType>(name, descr);
-    consts_.emplace_back(std::move(c));
-    int sz = static_cast<int>(consts_.size());
-    return static_cast<std::uint16_t>(sz - 1);
+    return intern_(
+        makeKey(ConstantType::NameAndType, name, descr), [&] {
+        return std::make_unique<constant::NameAndType>(name, descr);
+    });
 }
 
-std::uint16_t 
+std::uint16_t
 JVMConstantPool::addUtf8Name(const std::string& name) {
-    auto c = std::make_unique<constant::Utf8>(name);
-    consts_.emplace_back(std::move(c));
-    int sz = static_cast<int>(consts_.size());
-    int idx = static_cast<std::uint16_t>(sz - 1);
-    named_[name] = idx;
-    return idx;
+    return addUtf8(name);
 }
 
-std::uint16_t 
+std::uint16_t
 JVMConstantPool::addFieldDescriptor(
-    const descriptor::JVMFieldDescriptor& descr) 
+    const descriptor::JVMFieldDescriptor& descr)
 {
     return addUtf8(descr.toString());
 }
 
-std::uint16_t 
+std::uint16_t
 JVMConstantPool::addMethodDescriptor(
-    const descriptor::JVMMethodDescriptor& descr) 
+    const descriptor::JVMMethodDescriptor& descr)
 {
     return addUtf8(descr.toString());
 }
 
 std::pair<bool, std::uint16_t>
 JVMConstantPool::getUtf8NameIdx(const std::string& name) {
-    decltype(named_.begin()) it;
-    if ((it = named_.find(name)) != named_.end()) {
-        return {true, it->second};
-    }
-
-    return {false, 0};
+    auto key = makeKey(ConstantType::Utf8, name);
+    return found(find_(key, hashKey(key)));
 }
 
 std::pair<bool, std::uint16_t>
 JVMConstantPool::getNumbConstIdx(double numb) {
-    decltype(doubleCnst_.begin()) it;
-    if ((it = doubleCnst_.find(numb)) != doubleCnst_.end()) {
-        return {true, it->second};
-    }
-
-    return {false, 0};
+    auto key = makeKey(ConstantType::Double,
+                       std::bit_cast<std::uint64_t>(numb));
+    return found(find_(key, hashKey(key)));
 }
 
 std::pair<bool, std::uint16_t>
 JVMConstantPool::getNumbConstIdx(float numb) {
-    decltype(floatCnst_.begin()) it;
-    if ((it = floatCnst_.find(numb)) != floatCnst_.end()) {
-        return {true, it->second};
-    }
-
-    return {false, 0};
+    auto key = makeKey(ConstantType::Float,
+                       std::bit_cast<std::uint32_t>(numb));
+    return found(find_(key, hashKey(key)));
 }
 
 std::pair<bool, std::uint16_t>
 JVMConstantPool::getNumbConstIdx(int numb) {
-    decltype(intCnst_.begin()) it;
-    if ((it = intCnst_.find(numb)) != intCnst_.end()) {
-        return {true, it->second};
-    }
-
-    return {false, 0};
+    auto key = makeKey(ConstantType::Integer, numb);
+    return found(find_(key, hashKey(key)));
 }
 
 std::pair<bool, std::uint16_t>
 JVMConstantPool::getNumbConstIdx(std::int64_t numb) {
-    decltype(longCnst_.begin()) it;
-    if ((it = longCnst_.find(numb)) != longCnst_.end()) {
-        return {true, it->second};
-    }
-
-    return {false, 0};
+    auto key = makeKey(ConstantType::Long, numb);
+    return found(find_(key, hashKey(key)));
 }
 
-std::pair<bool, std::uint16_t> 
+std::pair<bool, std::uint16_t>
 JVMConstantPool::getStringIdx(
-    const std::string& string) 
+    const std::string& string)
 {
-    decltype(stringCnst_.begin()) it;
-    if ((it = stringCnst_.find(string)) != stringCnst_.end()) {
-        return {true, it->second};
+    auto [ok, utf8Idx] = getUtf8NameIdx(string);
+    if (!ok) {
+        return {false, 0};
     }
-
-    return {false, 0};
+    auto key = makeKey(ConstantType::String, utf8Idx);
+    return found(find_(key, hashKey(key)));
 }
 
 
 std::pair<bool, std::uint16_t>
 JVMConstantPool::getClassIdx(
-        const std::string& name) 
+        const std::string& name)
 {
-    decltype(classesCnst_.begin()) it;
-    if ((it = classesCnst_.find(name)) != classesCnst_.end()) {
-        return {true, it->second};
+    auto [ok, utf8Idx] = getUtf8NameIdx(name);
+    if (!ok) {
+        return {false, 0};
     }
-
-    return {false, 0};
+    auto key = makeKey(ConstantType::Class, utf8Idx);
+    return found(find_(key, hashKey(key)));
 }
 
 void JVMConstantPool::printBytes(
-    std::ostream& out) const 
+    utility::ByteSink& out) const
 {
     for (auto&& c : consts_) {
         if (c) {
@@ -223,4 +289,8 @@ std::uint16_t JVMConstantPool::size() const noexcept {
         consts_.size());
 }
 
-} // namespace constant_pool
\ No newline at end of file
+std::size_t JVMConstantPool::dedupHits() const noexcept {
+    return hits_;
+}
+
+} // namespace constant_pool
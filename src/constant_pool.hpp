@@ -1,14 +1,16 @@
-#pragma once 
+#pragma once
 
 #include "constant.hpp"
 
 #include <utility>
 #include <vector>
-#include <map>
 #include <memory>
+#include <string>
 
 namespace constant_pool {
 
+// все add* дедуплицируют: одинаковая (tag, payload)
+// константа возвращает уже выданный индекс
 class JVMConstantPool {
 public:
     JVMConstantPool();
@@ -23,7 +25,7 @@ public:
     std::uint16_t addClass(const std::string& name);
     std::uint16_t addFieldRef(std::uint16_t cls, std::uint16_t nameNType);
     std::uint16_t addMehodRef(std::uint16_t cls, std::uint16_t nameNType);
-    std::uint16_t addNameAndType(std::uint16_t name, std::uint16_t descr); 
+    std::uint16_t addNameAndType(std::uint16_t name, std::uint16_t descr);
 
     std::uint16_t addFieldDescriptor(
         const descriptor::JVMFieldDescriptor& descr);
@@ -44,23 +46,36 @@ public:
         const std::string& name);
 
 public:
-    void printBytes(std::ostream& out) const;
-    
+    void printBytes(utility::ByteSink& out) const;
+
 public:
+    // constant_pool_count: число слотов + 1 (long/double занимают 2)
     std::uint16_t size() const noexcept;
+    // сколько раз add* вернул уже существующую константу
+    std::size_t dedupHits() const noexcept;
+
+private:
+    // слот хеш-таблицы, idx == 0 - пустой
+    struct Slot {
+        std::uint32_t hash = 0;
+        std::uint16_t idx = 0;
+    };
+
+    std::uint16_t find_(const std::string& key, std::uint32_t hash) const;
+    template<class Make>
+    std::uint16_t intern_(std::string key, Make make, bool wide = false);
+    void rehash_(std::size_t capacity);
 
 private:
     std::vector<std::unique_ptr<constant::IConstant>> consts_;
-    std::map<std::string, std::uint16_t> named_;
-
-    std::map<double, std::uint16_t> doubleCnst_;
-    std::map<float, std::uint16_t> floatCnst_;
-    std::map<int, std::uint16_t> intCnst_;
-    std::map<std::int64_t, std::uint16_t> longCnst_;
-    std::map<std::string, std::uint16_t> classesCnst_;
-    std::map<std::string, std::uint16_t> stringCnst_;
+    // (tag, payload) каждой константы, индекс как в consts_
+    std::vector<std::string> keys_;
+    // открытая адресация, линейное пробирование
+    std::vector<Slot> table_;
+    std::size_t count_ = 0;
+    std::size_t hits_ = 0;
 };
 
 using SharedPtrJVMCP = std::shared_ptr<JVMConstantPool>;
 
-} // namespace constant_pool
\ No newline at end of file
+} // namespace constant_pool
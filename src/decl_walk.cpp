@@ -0,0 +1,96 @@
+#include "decl_walk.hpp"
+
+#include <sstream>
+#include <stdexcept>
+
+#include "node.hpp"
+
+namespace semantics_part {
+
+void DeclWalk::add(std::shared_ptr<IDeclCheck> check, std::string name) {
+    checks_.push_back(std::move(check));
+    names_.push_back(std::move(name));
+}
+
+std::string DeclWalk::name() const {
+    std::string res;
+    for (auto&& n : names_) {
+        if (!res.empty()) {
+            res += '+';
+        }
+        res += n;
+    }
+    return res;
+}
+
+std::vector<std::string> DeclWalk::after() const {
+    std::vector<std::string> res{"GlobalSpaceCreation"};
+    for (auto&& check : checks_) {
+        auto names = check->after();
+        res.insert(res.end(), names.begin(), names.end());
+    }
+    return res;
+}
+
+std::string DeclWalk::analyseModule(
+    const std::shared_ptr<mdl::Module>& mod)
+{
+    auto space = 
+        std::dynamic_pointer_cast<node::GlobalSpace>(mod->unit().lock());
+    if (!space) {
+        throw std::logic_error(
+            "Internal error in decl_walk.cpp");
+    }
+    std::vector<node::IDecl*> path;
+    auto res = walk_(space->unit(), path);
+    if (!res.empty()) {
+        std::stringstream ss;
+        ss << mod->fileName();
+        ss << ":";
+        ss << res;
+        return ss.str();
+    }
+    return "";
+}
+
+std::string DeclWalk::walk_(
+    const std::shared_ptr<node::IDecl>& decl,
+    std::vector<node::IDecl*>& path)
+{
+    visit();
+    for (auto&& check : checks_) {
+        auto res = check->enter(decl, path);
+        if (!res.empty()) {
+            return res;
+        }
+    }
+
+    std::shared_ptr<node::DeclArea> areas[2];
+    if (auto proc = std::dynamic_pointer_cast<node::ProcBody>(decl)) {
+        areas[0] = proc->decls();
+    } else if (auto pack = std::dynamic_pointer_cast<node::PackDecl>(decl)) {
+        areas[0] = pack->decls();
+        areas[1] = pack->privateDecls();
+    } else if (auto record = std::dynamic_pointer_cast<node::RecordDecl>(decl)) {
+        areas[0] = record->decls();
+    } else {
+        return "";
+    }
+
+    path.push_back(decl.get());
+    for (auto&& decls : areas) {
+        if (!decls) {
+            continue;
+        }
+        for (auto&& d : *decls) {
+            auto res = walk_(d, path);
+            if (!res.empty()) {
+                return res;
+            }
+        }
+    }
+    path.pop_back();
+    return "";
+}
+
+} // namespace semantics_part
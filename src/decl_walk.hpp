@@ -0,0 +1,56 @@
+#pragma once
+
+#include "isemantics_part.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace node {
+    class IDecl;
+}
+
+namespace semantics_part {
+
+// проверка для совмещенного обхода DeclWalk; как и IModulePart,
+// меняет только узлы модуля, в котором находится decl
+struct IDeclCheck {
+    virtual ~IDeclCheck() = default;
+
+    // проходы, которые должны отработать до проверки
+    virtual std::vector<std::string> after() const { return {}; }
+
+    // вызывается на каждом декле, родитель раньше детей;
+    // path - контейнеры от юнита модуля до родителя decl,
+    // для самого юнита пуст; непустая строка - ошибка
+    virtual std::string enter(
+        const std::shared_ptr<node::IDecl>& decl,
+        const std::vector<node::IDecl*>& path) = 0;
+};
+
+// один обход деклараций всех модулей вместо своего у каждой проверки:
+// ProcBody -> decls, PackDecl -> decls и privateDecls, RecordDecl -> decls.
+// На каждом декле проверки вызываются в порядке add, поэтому в один 
+// обход кладутся только не зависящие друг от друга проверки
+class DeclWalk : public IModulePart {
+public:
+    void add(std::shared_ptr<IDeclCheck> check, std::string name);
+
+    // имена проверок через '+'
+    std::string name() const;
+    std::vector<std::string> after() const override;
+
+    std::string analyseModule(
+            const std::shared_ptr<mdl::Module>& mod) override;
+
+private:
+    std::string walk_(
+        const std::shared_ptr<node::IDecl>& decl,
+        std::vector<node::IDecl*>& path);
+
+private:
+    std::vector<std::shared_ptr<IDeclCheck>> checks_;
+    std::vector<std::string> names_;
+};
+
+} // namespace semantics_part
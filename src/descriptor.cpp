@@ -135,6 +135,22 @@ JVMMethodDescriptor::params() const noexcept {
     return params_;
 }
 
+int JVMMethodDescriptor::paramsSize() const noexcept {
+    int sz = 0;
+    for (auto&& [_, s] : params_) {
+        sz += s;
+    }
+    return sz;
+}
+
+int JVMMethodDescriptor::retSize() const noexcept {
+    auto ret = descr_[descr_.find(')') + 1];
+    if ('V' == ret) {
+        return 0;
+    }
+    return 'J' == ret || 'D' == ret ? 2 : 1;
+}
+
 JVMMethodDescriptor::
 JVMMethodDescriptor(std::string descr,
     std::vector<std::pair<std::string, int>> params) :
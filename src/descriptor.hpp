@@ -56,6 +56,9 @@ public:
     const std::string& toString() const noexcept;
     const std::vector<std::pair<std::string, int>>& 
     params() const noexcept;
+    // в слотах стека
+    int paramsSize() const noexcept;
+    int retSize() const noexcept;
 
 private:
     JVMMethodDescriptor(std::string, 
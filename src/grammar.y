@@ -10,7 +10,8 @@
 %skeleton "lalr1.cc"
 
 %locations
-%param {FlexLexer* lexer}
+%param {lexer::Lexer* lexer}
+%parse-param {helper::ParseContext& ctx}
 %define api.value.type variant
 /* %define parse.trace */   /* uncom for trace */ 
 
@@ -26,11 +27,14 @@
   #include "location.hh"
 
   #include "node.hpp"
+
   #include "graphviz.hpp"
   #include "module.hpp"
   #include "string_utility.hpp"
 
-  class FlexLexer; 
+  namespace lexer {
+      class Lexer;
+  } // namespace lexer
 
   using OptionalImports = typename 
     std::pair<std::vector<std::shared_ptr<node::With>>, 
@@ -38,26 +42,20 @@
                 
   using ArgsType = typename std::vector<std::shared_ptr<node::IExpr>>;
 
+
   namespace helper {
-      extern std::vector<
-          std::shared_ptr<mdl::Module>> modules;
-      extern std::set<std::string> allModules;
-      extern std::queue<std::string> modulesForPars;
-      extern std::string curModuleFileName;
-      extern std::string curModuleName;
-      extern bool rightEnding;
-      extern std::string curModuleFileExtension;
+      struct ParseContext;
   } // namespace helper
 }
 
 %code 
 {
-  #include <FlexLexer.h>
+  #include "lexer.hpp"
 
   namespace yy {
       parser::token_type yylex(parser::semantic_type* yylval, 
                                 yy::parser::location_type*,  
-                                FlexLexer* lexer); 
+                                lexer::Lexer* lexer); 
   }
 
 }
@@ -67,13 +65,13 @@
 %token SC COLON COMMA DOT_DOT APOSTR
 %right ASG
 %token IF THEN ELSE ELSIF WHEN
-%token FOR LOOP WHILE EXIT IN OUT
+%token FOR LOOP WHILE EXIT IN OUT CONSTANT
 %token PROCEDURE FUNCTION RETURN IS BEGIN_KW END OVERRIDING NEW
 %token PACKAGE BODY PRIVATE WITH USE
 %token ARRAY OF TYPE TAGGED RECORD
 %token INTEGERTY STRINGTY CHARACTERTY FLOATTY BOOLTY
 %token<bool> BOOL NULL_KW
-%token<std::string> NAME
+%token<attribute::Symbol> NAME
 %token<int> INTEGER
 %token<float> FLOAT
 %token<char> CHAR
@@ -152,20 +150,19 @@
 program: optional_imports compile_unit                                  { 
                                                                           auto mod = std::make_shared<mdl::Module>(
                                                                             $2, $1.first, $1.second, 
-                                                                            helper::curModuleName, helper::curModuleFileName,     
-                                                                            helper::curModuleFileExtension);
-                                                                          helper::modules.push_back(mod);
+                                                                            ctx.moduleName, ctx.fileName,     
+                                                                            ctx.fileExtension);
+                                                                          ctx.module = mod;
                                                                         }
 
 /* declarations */
 /* ################################################################################ */
 with:             WITH qualified_name SC                                { 
-                                                                          auto mdl = $2.first();
+                                                                          std::string mdl = $2.first();
                                                                           utility::toLower(mdl);
-                                                                          if (!helper::allModules.contains(mdl) && mdl != helper::curModuleName)
+                                                                          if (mdl != ctx.moduleName && ctx.onImport)
                                                                           { 
-                                                                            helper::modulesForPars.push($2.first()); 
-                                                                            helper::allModules.insert(mdl);
+                                                                            ctx.onImport(mdl);
                                                                           }
                                                                           $$.reset(new node::With($2)); 
                                                                         }
@@ -205,6 +202,12 @@ var_decl:         NAME COLON type ASG expr SC                           {
                                                                           $$.reset(var); 
                                                                           $5->setVarDecl(var);
                                                                         }
+                | NAME COLON CONSTANT type ASG expr SC                  { 
+                                                                          auto var = new node::VarDecl($1, $4, $6);
+                                                                          var->setConstant();
+                                                                          $$.reset(var); 
+                                                                          $6->setVarDecl(var);
+                                                                        }
                 | NAME COLON type SC                                    { $$.reset(new node::VarDecl($1, $3)); }
 
 qualified_name:   NAME                                                  { $$ = attribute::QualifiedName($1); } 
@@ -212,20 +215,20 @@ qualified_name:   NAME                                                  { $$ = a
 
 proc_body:        PROCEDURE NAME IS optional_decl_area BEGIN_KW body END NAME SC                                     { 
                                                                                                                         $$.reset(new node::ProcBody($2, {}, $4, $6));
-                                                                                                                        helper::rightEnding = ($2 == $8) && helper::rightEnding;
+                                                                                                                        ctx.rightEnding = ($2 == $8) && ctx.rightEnding;
                                                                                                                      }
                 | PROCEDURE NAME LPAR param_list RPAR IS optional_decl_area BEGIN_KW body END NAME SC                { 
                                                                                                                         $$.reset(new node::ProcBody($2, $4, $7, $9)); 
-                                                                                                                        helper::rightEnding = ($2 == $11) && helper::rightEnding;
+                                                                                                                        ctx.rightEnding = ($2 == $11) && ctx.rightEnding;
                                                                                                                      }
 
 func_body:        FUNCTION NAME RETURN type IS optional_decl_area BEGIN_KW body END NAME SC                          { 
                                                                                                                         $$.reset(new node::FuncBody($2, {}, $6, $8, $4)); 
-                                                                                                                        helper::rightEnding = ($2 == $10) && helper::rightEnding;
+                                                                                                                        ctx.rightEnding = ($2 == $10) && ctx.rightEnding;
                                                                                                                      }  
                 | FUNCTION NAME LPAR param_list RPAR RETURN type IS optional_decl_area BEGIN_KW body END NAME SC     { 
                                                                                                                         $$.reset(new node::FuncBody($2, $4, $9, $11, $7)); 
-                                                                                                                        helper::rightEnding = ($2 == $13) && helper::rightEnding;
+                                                                                                                        ctx.rightEnding = ($2 == $13) && ctx.rightEnding;
                                                                                                                      }
 
 proc_decl:        PROCEDURE NAME SC                                                                                  { $$.reset(new node::ProcDecl($2)); }
@@ -236,20 +239,20 @@ func_decl:        FUNCTION NAME RETURN type SC
 
 pack_decl:        PACKAGE NAME IS pack_decl_decl_area PRIVATE pack_decl_decl_area END NAME SC                        { 
                                                                                                                         $$.reset(new node::PackDecl($2, $4, $6)); 
-                                                                                                                        helper::rightEnding = ($2 == $8) && helper::rightEnding;
+                                                                                                                        ctx.rightEnding = ($2 == $8) && ctx.rightEnding;
                                                                                                                      }
                 | PACKAGE NAME IS pack_decl_decl_area END NAME SC                                                    {  
                                                                                                                         $$.reset(new node::PackDecl($2, $4)); 
-                                                                                                                        helper::rightEnding = ($2 == $6) && helper::rightEnding;
+                                                                                                                        ctx.rightEnding = ($2 == $6) && ctx.rightEnding;
                                                                                                                      }
                 | PACKAGE NAME IS PRIVATE pack_decl_decl_area END NAME SC                                            { 
                                                                                                                         $$.reset(new node::PackDecl($2, nullptr, $5)); 
-                                                                                                                        helper::rightEnding = ($2 == $7) && helper::rightEnding;
+                                                                                                                        ctx.rightEnding = ($2 == $7) && ctx.rightEnding;
                                                                                                                      }
 
 pack_body:        PACKAGE BODY NAME IS decl_area END NAME SC                                                         { 
                                                                                                                         $$.reset(new node::PackBody($3, $5)); 
-                                                                                                                        helper::rightEnding = ($3 == $7) && helper::rightEnding;
+                                                                                                                        ctx.rightEnding = ($3 == $7) && ctx.rightEnding;
                                                                                                                      }
 
 type_decl:        record_decl                    
@@ -481,20 +484,19 @@ while_stm:       WHILE expr LOOP body END LOOP SC                       { $$.res
 
 %%
 
-#include "helper.hpp"
-
 namespace yy {
   parser::token_type yylex(parser::semantic_type* val, 
                             yy::parser::location_type* loc, 
-                            FlexLexer* lexer) 
+                            lexer::Lexer* lexer) 
   {
-    helper::yylval = val; 
+    auto&& ctx = lexer->context();
+    ctx.yylval = val; 
     auto tt = static_cast<parser::token_type>(lexer->yylex());
-    loc->initialize(&helper::curModuleFileName);
-    loc->begin.line = helper::first_line;
-    loc->end.line = helper::last_line;
-    loc->begin.column = helper::first_column - 1;
-    loc->end.column = helper::last_column;
+    loc->initialize(&ctx.fileName.str());
+    loc->begin.line = ctx.first_line;
+    loc->end.line = ctx.last_line;
+    loc->begin.column = ctx.first_column - 1;
+    loc->end.column = ctx.last_column;
     return tt;
   }
 
@@ -503,6 +505,6 @@ namespace yy {
   {
     std::stringstream ss;
     ss << loc << ' ' << msg << std::endl;
-    helper::errs.push_back(ss.str());
+    ctx.errs.push_back(ss.str());
   }
 }
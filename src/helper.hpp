@@ -7,19 +7,33 @@
 #include <string>
 #include <set>
 #include <queue>
+#include <functional>
 
 namespace helper {
-    extern yy::parser::semantic_type* yylval;
+    // состояние разбора одного файла (.adb или .ads):
+    // у каждого потока разбора - свое
+    struct ParseContext {
+        yy::parser::semantic_type* yylval = nullptr;
+        int first_line = 1;
+        int last_line = 1;
+        int first_column = 1;
+        int last_column = 1;
+        std::string moduleName;
+        // Symbol: yy::location хранит указатель на имя файла,
+        // а строки Symbol живут до конца программы
+        attribute::Symbol fileName;
+        std::string fileExtension;
+        bool rightEnding = true;
+        std::vector<std::string> errs;
+        std::shared_ptr<mdl::Module> module;
+        // найден with-модуль (имя в нижнем регистре)
+        std::function<void(const std::string&)> onImport;
+    };
+
     extern std::vector<std::string> errs;
-    extern int first_line;  
-    extern int last_line;
-    extern int first_column;
-    extern int last_column;
     extern std::vector<
         std::shared_ptr<mdl::Module>> modules;
     extern std::set<std::string> allModules;
     extern std::queue<std::string> modulesForPars;
-    extern std::string curModule;
     extern bool rightEnding;
-    extern std::string curModuleFileExtension;
-} // namespace helper
\ No newline at end of file
+} // namespace helper
@@ -2,8 +2,205 @@
 
 #include "bits_utility.hpp"
 
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
 namespace instr {
 
+StackEffect opStackEffect(OpCode op) {
+    using O = OpCode;
+
+    switch (op) {
+        case O::nop: case O::iinc: case O::goto_: case O::goto_w: 
+        case O::ret: case O::return_: case O::breakpoint: 
+        case O::impdep1: case O::impdep2:
+            return {0, 0};
+
+        case O::aconst_null: case O::iconst_m1: case O::iconst_0: 
+        case O::iconst_1: case O::iconst_2: case O::iconst_3: 
+        case O::iconst_4: case O::iconst_5: case O::fconst_0: 
+        case O::fconst_1: case O::fconst_2: case O::bipush: 
+        case O::sipush: case O::ldc: case O::ldc_w: 
+        case O::new_: case O::jsr: case O::jsr_w:
+            return {0, 1};
+
+        case O::lconst_0: case O::lconst_1:
+        case O::dconst_0: case O::dconst_1: case O::ldc2_w:
+            return {0, 2};
+
+        case O::iload: case O::iload_0: case O::iload_1:
+        case O::iload_2: case O::iload_3:
+        case O::fload: case O::fload_0: case O::fload_1:
+        case O::fload_2: case O::fload_3:
+        case O::aload: case O::aload_0: case O::aload_1:
+        case O::aload_2: case O::aload_3:
+            return {0, 1};
+
+        case O::lload: case O::lload_0: case O::lload_1:
+        case O::lload_2: case O::lload_3:
+        case O::dload: case O::dload_0: case O::dload_1:
+        case O::dload_2: case O::dload_3:
+            return {0, 2};
+
+        case O::iaload: case O::faload: case O::aaload: 
+        case O::baload: case O::caload: case O::saload:
+            return {2, 1};
+        case O::laload: case O::daload:
+            return {2, 2};
+
+        case O::istore: case O::istore_0: case O::istore_1:
+        case O::istore_2: case O::istore_3:
+        case O::fstore: case O::fstore_0: case O::fstore_1:
+        case O::fstore_2: case O::fstore_3:
+        case O::astore: case O::astore_0: case O::astore_1:
+        case O::astore_2: case O::astore_3:
+            return {1, 0};
+
+        case O::lstore: case O::lstore_0: case O::lstore_1:
+        case O::lstore_2: case O::lstore_3:
+        case O::dstore: case O::dstore_0: case O::dstore_1:
+        case O::dstore_2: case O::dstore_3:
+            return {2, 0};
+
+        case O::iastore: case O::fastore: case O::aastore: 
+        case O::bastore: case O::castore: case O::sastore:
+            return {3, 0};
+        case O::lastore: case O::dastore:
+            return {4, 0};
+
+        case O::pop:     return {1, 0};
+        case O::pop2:    return {2, 0};
+        case O::dup:     return {1, 2};
+        case O::dup_x1:  return {2, 3};
+        case O::dup_x2:  return {3, 4};
+        case O::dup2:    return {2, 4};
+        case O::dup2_x1: return {3, 5};
+        case O::dup2_x2: return {4, 6};
+        case O::swap:    return {2, 2};
+
+        case O::iadd: case O::isub: case O::imul: case O::idiv: 
+        case O::irem: case O::iand: case O::ior: case O::ixor:
+        case O::ishl: case O::ishr: case O::iushr:
+        case O::fadd: case O::fsub: case O::fmul: case O::fdiv: 
+        case O::frem: case O::fcmpl: case O::fcmpg:
+            return {2, 1};
+
+        case O::ladd: case O::lsub: case O::lmul: case O::ldiv: 
+        case O::lrem: case O::land: case O::lor: case O::lxor:
+        case O::dadd: case O::dsub: case O::dmul: case O::ddiv: 
+        case O::drem:
+            return {4, 2};
+
+        case O::lshl: case O::lshr: case O::lushr:
+            return {3, 2};
+
+        case O::lcmp: case O::dcmpl: case O::dcmpg:
+            return {4, 1};
+
+        case O::ineg: case O::fneg: case O::i2f: case O::f2i: 
+        case O::i2b: case O::i2c: case O::i2s:
+        case O::newarray: case O::anewarray: case O::arraylength:
+        case O::checkcast: case O::instanceof:
+            return {1, 1};
+
+        case O::lneg: case O::dneg: case O::l2d: case O::d2l:
+            return {2, 2};
+
+        case O::i2l: case O::i2d: case O::f2l: case O::f2d:
+            return {1, 2};
+
+        case O::l2i: case O::l2f: case O::d2i: case O::d2f:
+            return {2, 1};
+
+        case O::ifeq: case O::ifne: case O::iflt: case O::ifge: 
+        case O::ifgt: case O::ifle: case O::ifnull: case O::ifnonnull:
+        case O::tableswitch: case O::lookupswitch:
+        case O::ireturn: case O::freturn: case O::areturn:
+        case O::athrow: case O::monitorenter: case O::monitorexit:
+            return {1, 0};
+
+        case O::if_icmpeq: case O::if_icmpne: case O::if_icmplt: 
+        case O::if_icmpge: case O::if_icmpgt: case O::if_icmple:
+        case O::if_acmpeq: case O::if_acmpne:
+        case O::lreturn: case O::dreturn:
+            return {2, 0};
+
+        default:
+            throw std::logic_error("The stack effect of the opcode" 
+                                   " depends on a descriptor");
+    }
+}
+
+
+bool breaksFlow(OpCode op) {
+    using O = OpCode;
+
+    switch (op) {
+        case O::goto_: case O::goto_w: case O::ret:
+        case O::tableswitch: case O::lookupswitch:
+        case O::ireturn: case O::lreturn: case O::freturn:
+        case O::dreturn: case O::areturn: case O::return_:
+        case O::athrow:
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::optional<OpCode> invertBranch(OpCode op) {
+    using O = OpCode;
+
+    switch (op) {
+        case O::ifeq:      return O::ifne;
+        case O::ifne:      return O::ifeq;
+        case O::iflt:      return O::ifge;
+        case O::ifge:      return O::iflt;
+        case O::ifgt:      return O::ifle;
+        case O::ifle:      return O::ifgt;
+        case O::if_icmpeq: return O::if_icmpne;
+        case O::if_icmpne: return O::if_icmpeq;
+        case O::if_icmplt: return O::if_icmpge;
+        case O::if_icmpge: return O::if_icmplt;
+        case O::if_icmpgt: return O::if_icmple;
+        case O::if_icmple: return O::if_icmpgt;
+        case O::if_acmpeq: return O::if_acmpne;
+        case O::if_acmpne: return O::if_acmpeq;
+        case O::ifnull:    return O::ifnonnull;
+        case O::ifnonnull: return O::ifnull;
+        default:
+            return std::nullopt;
+    }
+}
+
+namespace {
+
+// xload_n / xstore_n для слотов 0..3
+std::optional<OpCode> shortLocalOp(OpCode op, std::uint16_t slot) {
+    if (slot > 3) {
+        return std::nullopt;
+    }
+    using O = OpCode;
+    O base;
+    switch (op) {
+        case O::iload:  base = O::iload_0;  break;
+        case O::lload:  base = O::lload_0;  break;
+        case O::fload:  base = O::fload_0;  break;
+        case O::dload:  base = O::dload_0;  break;
+        case O::aload:  base = O::aload_0;  break;
+        case O::istore: base = O::istore_0; break;
+        case O::lstore: base = O::lstore_0; break;
+        case O::fstore: base = O::fstore_0; break;
+        case O::dstore: base = O::dstore_0; break;
+        case O::astore: base = O::astore_0; break;
+        default: 
+            return std::nullopt;
+    }
+    return static_cast<O>(static_cast<std::uint8_t>(base) + slot);
+}
+
+} // namespace
+
 Instr::Instr(OpCode op, bool isBranch) : 
     op_(op)
     , isBranch_(isBranch) 
@@ -17,18 +214,29 @@ void Instr::setIdx(std::uint32_t idx) noexcept {
     idx_ = idx;
 }
 
-void Instr::printBytes(std::ostream& out) const {
-    auto op = static_cast<std::uint8_t>(op_);
-    utility::printBytes(out, op);
-
-    for (auto b : bytes_) {
-        utility::printBytes(out, b);
+void Instr::printBytes(utility::ByteSink& out) const {
+    if (local_) {
+        printLocalBytes_(out);
+        return;
     }
+    std::array<char, 1 + maxOperands> buf;
+    buf[0] = static_cast<char>(op_);
+    std::copy_n(bytes_.begin(), size_, buf.begin() + 1);
+    out.write(buf.data(), 1 + size_);
 }
 
 std::uint32_t Instr::len() const noexcept {
-    auto sz 
-        = static_cast<std::uint32_t>(bytes_.size());
+    std::uint32_t sz = size_;
+    if (local_) {
+        if (shortLocalOp(op_, slot_)) {
+            return 1;
+        }
+        if (slot_ > std::numeric_limits<std::uint8_t>::max()) {
+            // wide op idx1 idx2 [const1 const2]
+            return 4 + 2 * sz;
+        }
+        return 2 + sz;
+    }
     return 1 + sz;
 }
 
@@ -40,22 +248,88 @@ bool Instr::isBranch() const noexcept {
     return isBranch_;
 }
 
+std::span<const std::uint8_t> Instr::operands() const noexcept {
+    return {bytes_.data(), size_};
+}
+
 void Instr::pushByte(std::uint8_t byte) {
-    bytes_.push_back(byte);
+    if (size_ == maxOperands) {
+        throw std::logic_error("Too many instruction operands");
+    }
+    bytes_[size_++] = byte;
 }
 
 void Instr::pushTwoBytes(std::uint16_t bytes) {
     std::uint16_t mask = 0xff;
-    bytes_.push_back((bytes >> 8) & mask);
-    bytes_.push_back(bytes & mask);
+    pushByte((bytes >> 8) & mask);
+    pushByte(bytes & mask);
 }
 
 void Instr::pushFourBytes(std::uint32_t bytes) {
     std::uint16_t mask = 0xff;
-    bytes_.push_back((bytes >> 24) & mask);
-    bytes_.push_back((bytes >> 16) & mask);
-    bytes_.push_back((bytes >> 8) & mask);
-    bytes_.push_back(bytes & mask);
+    pushByte((bytes >> 24) & mask);
+    pushByte((bytes >> 16) & mask);
+    pushByte((bytes >> 8) & mask);
+    pushByte(bytes & mask);
+}
+
+void Instr::setLocal(std::uint32_t local) noexcept {
+    local_ = local;
+}
+
+std::optional<std::uint32_t> Instr::local() const noexcept {
+    return local_;
+}
+
+void Instr::setSlot(std::uint16_t slot) noexcept {
+    slot_ = slot;
+}
+
+void Instr::setFar() noexcept {
+    far_ = true;
+}
+
+bool Instr::far() const noexcept {
+    return far_;
+}
+
+void Instr::printLocalBytes_(utility::ByteSink& out) const {
+    if (auto op = shortLocalOp(op_, slot_)) {
+        out.put(static_cast<std::uint8_t>(*op));
+        return;
+    }
+    auto op = static_cast<std::uint8_t>(op_);
+    if (slot_ > std::numeric_limits<std::uint8_t>::max()) {
+        out.put(static_cast<std::uint8_t>(OpCode::wide));
+        out.put(op);
+        out.put(slot_);
+        for (auto b : operands()) { // iinc const -> 2 байта
+            auto wide = static_cast<std::uint16_t>(
+                static_cast<std::int8_t>(b));
+            out.put(wide);
+        }
+        return;
+    }
+    out.put(op);
+    out.put(static_cast<std::uint8_t>(slot_));
+    for (auto b : operands()) {
+        out.put(b);
+    }
+}
+
+void Instr::setStackEffect(StackEffect effect) noexcept {
+    stackEffect_ = effect;
+}
+
+StackEffect Instr::stackEffect() const {
+    if (stackEffect_) {
+        return *stackEffect_;
+    }
+    if (OpCode::wide == op_) { // wide <opcode> <idx>
+        return opStackEffect(
+            static_cast<OpCode>(operands().front()));
+    }
+    return opStackEffect(op_);
 }
 
 } // namespace instr
\ No newline at end of file
@@ -1,37 +1,88 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
+#include <optional>
 #include <ostream>
-#include <vector>
+#include <span>
 
 #include "opcode.hpp"
+#include "bits_utility.hpp"
 
 namespace instr {
 
+// слоты, снимаемые и кладущиеся на стек операндов
+struct StackEffect {
+    std::uint16_t pop;
+    std::uint16_t push;
+};
+
+// throw exception, if the effect depends on a descriptor
+StackEffect opStackEffect(OpCode op);
+
+// goto, return, athrow...: управление не переходит 
+// к следующей инструкции
+bool breaksFlow(OpCode op);
+
+// условный переход с противоположным условием
+// (nullopt, если op не условный переход)
+std::optional<OpCode> invertBranch(OpCode op);
+
+// запись фиксированного размера без выделений в куче:
+// операнды хранятся внутри (не больше maxOperands байт)
 class Instr {
 public:
+    static constexpr std::size_t maxOperands = 4;
+
     Instr(OpCode op, bool isBranch = false);
     
 public:
     std::uint32_t idx() const noexcept;
     void setIdx(std::uint32_t idx) noexcept;  
-    void printBytes(std::ostream& out) const;
+    void printBytes(utility::ByteSink& out) const;
     std::uint32_t len() const noexcept;
     OpCode opCode() const noexcept;
     bool isBranch() const noexcept;
+    std::span<const std::uint8_t> operands() const noexcept;
 
     void pushByte(std::uint8_t byte);
     void pushTwoBytes(std::uint16_t bytes);
     void pushFourBytes(std::uint32_t bytes);
 
+    // для invoke*, get/put* и multianewarray 
+    // эффект задается при создании по дескриптору
+    void setStackEffect(StackEffect effect) noexcept;
+    StackEffect stackEffect() const;
+
+    // xload, xstore, iinc: номер локальной переменной в CodeAttr;
+    // форма кодирования (xload_n, обычная, wide) выбирается 
+    // по слоту, назначенному после распределения
+    void setLocal(std::uint32_t local) noexcept;
+    std::optional<std::uint32_t> local() const noexcept;
+    void setSlot(std::uint16_t slot) noexcept;
+
+    // переход, до цели которого не хватает 16-битного смещения:
+    // goto/jsr кодируются как goto_w/jsr_w, условный - как
+    // инвертированный переход через следующий за ним goto_w
+    void setFar() noexcept;
+    bool far() const noexcept;
+
+private:
+    void printLocalBytes_(utility::ByteSink& out) const;
+
 private:
     // byte structure
-    const OpCode op_;
-    std::vector<std::uint8_t> bytes_;
+    OpCode op_;
+    std::uint8_t size_ = 0;
+    std::array<std::uint8_t, maxOperands> bytes_{};
 
     // class internals
     bool isBranch_;
-    std::uint32_t idx_;
+    bool far_ = false;
+    std::uint16_t slot_ = 0;
+    std::uint32_t idx_ = 0;
+    std::optional<StackEffect> stackEffect_;
+    std::optional<std::uint32_t> local_;
 };
 
 } // namespace instr
\ No newline at end of file
@@ -1,32 +1,71 @@
 #pragma once 
 
+#include <atomic>
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "module.hpp"
 
 namespace semantics_part {
 
+// проход семантики; запускает проходы по очереди semantics::ADASementics,
+// непустая строка из analyse - ошибка, дальше проходы не идут
 struct ISemanticsPart {
     virtual ~ISemanticsPart() = default;
 
-    void setTail(
-        std::weak_ptr<ISemanticsPart> tail);
-
     virtual std::string analyse(
                 const std::vector<
                     std::shared_ptr<mdl::Module>>& program) = 0; 
 
+    // имена проходов, которые должны быть добавлены раньше этого
+    virtual std::vector<std::string> after() const { return {}; }
+
+    // сколько узлов прошел обход с последнего сброса
+    std::size_t visits() const noexcept { 
+        return visits_.load(std::memory_order_relaxed); 
+    }
+    void resetVisits() noexcept { visits_ = 0; }
+
 protected:
-    std::string analyseNext(
-        const std::vector<
-                std::shared_ptr<mdl::Module>>& program);
+    // вызывается на входе в обход декла, тела или выражения
+    void visit() noexcept { 
+        visits_.fetch_add(1, std::memory_order_relaxed); 
+    }
 
 private:
-    std::weak_ptr<ISemanticsPart> next_;
+    std::atomic<std::size_t> visits_ = 0;
+};
+
+// проход, который на каждом модуле меняет только узлы этого модуля,
+// а в других модулях только читает: ADASementics может гонять его
+// по модулям параллельно (волнами по графу with)
+struct IModulePart : ISemanticsPart {
+    // первый анализируемый модуль (program[0] - стандартная библиотека)
+    virtual std::size_t firstModule() const { return 1; }
+
+    // ошибка - уже с именем файла; вызовы на разных модулях 
+    // могут идти из разных потоков одновременно
+    virtual std::string analyseModule(
+                const std::shared_ptr<mdl::Module>& mod) = 0;
+
+    // последовательно, до первой ошибки
+    std::string analyse(
+                const std::vector<
+                    std::shared_ptr<mdl::Module>>& program) override
+    {
+        for (auto i = firstModule(); i < program.size(); ++i) {
+            auto res = analyseModule(program[i]);
+            if (!res.empty()) {
+                return res;
+            }
+        }
+        return "";
+    }
 };
 
 using SharedPtr = std::shared_ptr<ISemanticsPart>;
 using WeakPtr = std::weak_ptr<ISemanticsPart>;
 
-} // namespace semantics_part
\ No newline at end of file
+} // namespace semantics_part
@@ -0,0 +1,358 @@
+#include "jar_writer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace jar {
+
+namespace {
+
+// zip little-endian
+class LEWriter {
+public:
+    explicit LEWriter(std::vector<std::byte>& out) : out_(out) {}
+
+    void u16(std::uint16_t v) {
+        out_.push_back(std::byte(v & 0xff));
+        out_.push_back(std::byte(v >> 8));
+    }
+
+    void u32(std::uint32_t v) {
+        u16(static_cast<std::uint16_t>(v & 0xffff));
+        u16(static_cast<std::uint16_t>(v >> 16));
+    }
+
+    void bytes(std::span<const std::byte> data) {
+        out_.insert(out_.end(), data.begin(), data.end());
+    }
+
+    void str(const std::string& s) {
+        bytes(std::as_bytes(std::span(s)));
+    }
+
+private:
+    std::vector<std::byte>& out_;
+};
+
+// deflate: биты упаковываются с младшего
+class BitWriter {
+public:
+    void put(std::uint32_t bits, int n) {
+        acc_ |= std::uint64_t(bits) << cnt_;
+        cnt_ += n;
+        while (cnt_ >= 8) {
+            out_.push_back(std::byte(acc_ & 0xff));
+            acc_ >>= 8;
+            cnt_ -= 8;
+        }
+    }
+
+    // коды Хаффмана пишутся со старшего бита
+    void putCode(std::uint32_t code, int n) {
+        std::uint32_t rev = 0;
+        for (int i = 0; i < n; ++i) {
+            rev = (rev << 1) | ((code >> i) & 1);
+        }
+        put(rev, n);
+    }
+
+    std::vector<std::byte> finish() {
+        if (cnt_) {
+            out_.push_back(std::byte(acc_ & 0xff));
+        }
+        acc_ = 0;
+        cnt_ = 0;
+        return std::move(out_);
+    }
+
+private:
+    std::vector<std::byte> out_;
+    std::uint64_t acc_ = 0;
+    int cnt_ = 0;
+};
+
+// фиксированные коды литералов/длин (RFC 1951, 3.2.6)
+void putLitLen(BitWriter& bw, std::uint32_t v) {
+    if (v <= 143) {
+        bw.putCode(0x30 + v, 8);
+    } else if (v <= 255) {
+        bw.putCode(0x190 + v - 144, 9);
+    } else if (v <= 279) {
+        bw.putCode(v - 256, 7);
+    } else {
+        bw.putCode(0xc0 + v - 280, 8);
+    }
+}
+
+constexpr std::array<std::uint16_t, 29> lenBase = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+constexpr std::array<std::uint8_t, 29> lenExtra = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+constexpr std::array<std::uint16_t, 30> distBase = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+    8193, 12289, 16385, 24577
+};
+constexpr std::array<std::uint8_t, 30> distExtra = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+void putMatch(BitWriter& bw, std::uint32_t len, std::uint32_t dist) {
+    auto l = std::upper_bound(lenBase.begin(), lenBase.end(), len)
+             - lenBase.begin() - 1;
+    putLitLen(bw, 257 + static_cast<std::uint32_t>(l));
+    bw.put(len - lenBase[l], lenExtra[l]);
+
+    auto d = std::upper_bound(distBase.begin(), distBase.end(), dist)
+             - distBase.begin() - 1;
+    bw.putCode(static_cast<std::uint32_t>(d), 5);
+    bw.put(dist - distBase[d], distExtra[d]);
+}
+
+constexpr std::size_t windowSize = 32768;
+constexpr std::size_t minMatch = 3;
+constexpr std::size_t maxMatch = 258;
+constexpr std::size_t maxChain = 64;
+constexpr std::size_t hashBits = 15;
+
+std::uint32_t hash3(const std::byte* p) {
+    auto v = std::uint32_t(p[0]) << 16 |
+             std::uint32_t(p[1]) << 8 |
+             std::uint32_t(p[2]);
+    return (v * 2654435761u) >> (32 - hashBits);
+}
+
+const std::array<std::uint32_t, 256>& crcTable() {
+    static const auto table = [] {
+        std::array<std::uint32_t, 256> t{};
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            auto c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+    return table;
+}
+
+// 1980-01-01 00:00: архив не зависит от времени сборки
+constexpr std::uint16_t dosTime = 0;
+constexpr std::uint16_t dosDate = (0 << 9) | (1 << 5) | 1;
+
+constexpr std::uint16_t methodStored = 0;
+constexpr std::uint16_t methodDeflate = 8;
+
+} // namespace
+
+std::uint32_t crc32(std::span<const std::byte> data) {
+    auto&& table = crcTable();
+    std::uint32_t c = 0xffffffffu;
+    for (auto b : data) {
+        c = table[(c ^ std::uint32_t(b)) & 0xff] ^ (c >> 8);
+    }
+    return c ^ 0xffffffffu;
+}
+
+// один финальный блок с фиксированными кодами,
+// LZ77 - жадный поиск по цепочкам хешей
+std::vector<std::byte> deflate(std::span<const std::byte> data) {
+    BitWriter bw;
+    bw.put(1, 1); // BFINAL
+    bw.put(1, 2); // BTYPE = 01
+
+    std::vector<std::int32_t> head(std::size_t(1) << hashBits, -1);
+    std::vector<std::int32_t> prev(data.size(), -1);
+    auto insert = [&] (std::size_t pos) {
+        if (pos + minMatch <= data.size()) {
+            auto h = hash3(&data[pos]);
+            prev[pos] = head[h];
+            head[h] = static_cast<std::int32_t>(pos);
+        }
+    };
+
+    std::size_t pos = 0;
+    while (pos < data.size()) {
+        std::size_t bestLen = 0;
+        std::size_t bestDist = 0;
+        if (pos + minMatch <= data.size()) {
+            auto limit = std::min(maxMatch, data.size() - pos);
+            auto cand = head[hash3(&data[pos])];
+            for (std::size_t chain = 0;
+                 cand >= 0 && chain < maxChain;
+                 ++chain, cand = prev[cand])
+            {
+                auto dist = pos - static_cast<std::size_t>(cand);
+                if (dist > windowSize) {
+                    break;
+                }
+                std::size_t len = 0;
+                while (len < limit && data[cand + len] == data[pos + len]) {
+                    ++len;
+                }
+                if (len > bestLen) {
+                    bestLen = len;
+                    bestDist = dist;
+                    if (len == limit) {
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (bestLen >= minMatch) {
+            putMatch(bw,
+                static_cast<std::uint32_t>(bestLen),
+                static_cast<std::uint32_t>(bestDist));
+            for (std::size_t k = 0; k < bestLen; ++k) {
+                insert(pos + k);
+            }
+            pos += bestLen;
+        } else {
+            putLitLen(bw, std::uint32_t(data[pos]));
+            insert(pos);
+            ++pos;
+        }
+    }
+    putLitLen(bw, 256); // конец блока
+    return bw.finish();
+}
+
+// JarWriter
+JarWriter::JarWriter(Compression compression) :
+    compression_(compression)
+{}
+
+void JarWriter::setMainClass(const std::string& name) {
+    mainClass_ = name;
+    std::ranges::replace(mainClass_, '/', '.');
+}
+
+void JarWriter::add(
+    const std::string& path, std::span<const std::byte> data)
+{
+    if (finished_) {
+        throw std::logic_error("Adding to a finished jar");
+    }
+    addEntry_(path, data);
+}
+
+void JarWriter::addEntry_(
+    const std::string& path, std::span<const std::byte> data)
+{
+    if (data.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("Jar entry " + path + " is too large");
+    }
+    Entry e{path, crc32(data),
+            static_cast<std::uint32_t>(data.size()),
+            methodStored, {}};
+    if (Compression::DEFLATE == compression_) {
+        auto packed = deflate(data);
+        // несжимаемое хранится как есть
+        if (packed.size() < data.size()) {
+            e.method = methodDeflate;
+            e.data = std::move(packed);
+        }
+    }
+    if (methodStored == e.method) {
+        e.data.assign(data.begin(), data.end());
+    }
+    entries_.push_back(std::move(e));
+}
+
+std::vector<std::byte> JarWriter::finish() {
+    if (!finished_) {
+        std::string manifest = "Manifest-Version: 1.0\r\n";
+        if (!mainClass_.empty()) {
+            manifest += "Main-Class: " + mainClass_ + "\r\n";
+        }
+        manifest += "Created-By: jada\r\n\r\n";
+        addEntry_("META-INF/MANIFEST.MF",
+                  std::as_bytes(std::span(manifest)));
+        std::rotate(entries_.begin(),
+                    std::prev(entries_.end()),
+                    entries_.end());
+        finished_ = true;
+    }
+
+    if (entries_.size() > std::numeric_limits<std::uint16_t>::max()) {
+        throw std::runtime_error("Too many jar entries");
+    }
+
+    std::vector<std::byte> out;
+    LEWriter w(out);
+    std::vector<std::uint32_t> offsets;
+    for (auto&& e : entries_) {
+        offsets.push_back(static_cast<std::uint32_t>(out.size()));
+        w.u32(0x04034b50);
+        w.u16(methodDeflate == e.method ? 20 : 10);
+        w.u16(0);
+        w.u16(e.method);
+        w.u16(dosTime);
+        w.u16(dosDate);
+        w.u32(e.crc);
+        w.u32(static_cast<std::uint32_t>(e.data.size()));
+        w.u32(e.size);
+        w.u16(static_cast<std::uint16_t>(e.path.size()));
+        w.u16(0);
+        w.str(e.path);
+        w.bytes(e.data);
+    }
+
+    auto cdStart = static_cast<std::uint32_t>(out.size());
+    for (std::size_t i = 0; i < entries_.size(); ++i) {
+        auto&& e = entries_[i];
+        w.u32(0x02014b50);
+        w.u16(20);
+        w.u16(methodDeflate == e.method ? 20 : 10);
+        w.u16(0);
+        w.u16(e.method);
+        w.u16(dosTime);
+        w.u16(dosDate);
+        w.u32(e.crc);
+        w.u32(static_cast<std::uint32_t>(e.data.size()));
+        w.u32(e.size);
+        w.u16(static_cast<std::uint16_t>(e.path.size()));
+        w.u16(0); // extra
+        w.u16(0); // comment
+        w.u16(0); // disk
+        w.u16(0); // internal attrs
+        w.u32(0); // external attrs
+        w.u32(offsets[i]);
+        w.str(e.path);
+    }
+    auto cdSize = static_cast<std::uint32_t>(out.size()) - cdStart;
+
+    auto count = static_cast<std::uint16_t>(entries_.size());
+    w.u32(0x06054b50);
+    w.u16(0);
+    w.u16(0);
+    w.u16(count);
+    w.u16(count);
+    w.u32(cdSize);
+    w.u32(cdStart);
+    w.u16(0);
+    return out;
+}
+
+void JarWriter::write(const std::filesystem::path& path) {
+    auto bytes = finish();
+    std::ofstream f(path,
+        std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!f.is_open()) {
+        throw std::runtime_error("The file cannot be opened");
+    }
+    f.write(reinterpret_cast<const char*>(bytes.data()),
+            static_cast<std::streamsize>(bytes.size()));
+}
+
+} // namespace jar
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace jar {
+
+enum class Compression {
+    STORED,     // без сжатия: быстрее старт JVM
+    DEFLATE     // deflate с фиксированными кодами Хаффмана
+};
+
+// jar (zip) целиком в памяти; META-INF/MANIFEST.MF
+// добавляется первой записью в finish
+class JarWriter {
+public:
+    explicit JarWriter(Compression compression);
+
+public:
+    // класс с точкой входа, имя через '/' или '.'
+    void setMainClass(const std::string& name);
+    void add(const std::string& path, std::span<const std::byte> data);
+
+    // -> байты архива; после вызова add запрещен
+    std::vector<std::byte> finish();
+    void write(const std::filesystem::path& path);
+
+private:
+    struct Entry {
+        std::string path;
+        std::uint32_t crc;
+        std::uint32_t size;
+        std::uint16_t method;
+        std::vector<std::byte> data;
+    };
+
+    void addEntry_(const std::string& path,
+                   std::span<const std::byte> data);
+
+private:
+    Compression compression_;
+    std::string mainClass_;
+    std::vector<Entry> entries_;
+    bool finished_ = false;
+};
+
+// сырой поток deflate (RFC 1951), без заголовка zlib
+std::vector<std::byte> deflate(std::span<const std::byte> data);
+
+std::uint32_t crc32(std::span<const std::byte> data);
+
+} // namespace jar
@@ -7,21 +7,20 @@ namespace jvm_attribute {
 IAttribute::IAttribute(const std::string& name, 
                        constant_pool::SharedPtrJVMCP cp) 
 {
-    auto [f, idx] = cp->getUtf8NameIdx(name);
-    if (f) {
-        name_ = idx;
-    } else {
-        name_ = cp->addUtf8Name(name);
-    }
+    name_ = cp->addUtf8Name(name);
+}
+
+void IAttribute::setPool(constant_pool::SharedPtrJVMCP cp) {
+    name_ = cp->addUtf8Name(name());
 }
 
 void IAttribute::setAttrLent(std::uint32_t len) {
     attrLen_ = len;
 }
 
-void IAttribute::printBytes(std::ostream& out) const {
-    utility::printBytes(out, utility::reverse(name_));
-    utility::printBytes(out, utility::reverse(attrLen_));
+void IAttribute::printBytes(utility::ByteSink& out) const {
+    out.put(name_);
+    out.put(attrLen_);
 }
 
 } // namespace jvm_attribute
@@ -11,6 +11,10 @@
 #include "instruction.hpp"
 #include "basic_block.hpp"
 
+namespace peephole {
+    class Code;
+}
+
 namespace jvm_attribute {
     
 class IAttribute {
@@ -21,9 +25,11 @@ public:
     virtual ~IAttribute() = default;
     
     virtual const std::string& name() const noexcept = 0;
+    // переносит имя атрибута в другой constant pool
+    void setPool(constant_pool::SharedPtrJVMCP cp);
 
 public:
-    virtual void printBytes(std::ostream& out) const = 0;
+    virtual void printBytes(utility::ByteSink& out) const = 0;
 
 protected:
     void setAttrLent(std::uint32_t len);
@@ -41,15 +47,21 @@ class CodeAttr :
     public IAttribute 
     , public std::enable_shared_from_this<CodeAttr>
 { 
+    friend class peephole::Code;
+
 public:
     CodeAttr(constant_pool::SharedPtrJVMCP cp);
 
 public:
     bb::BasicBlock* createBB();
+    // bb перед всем остальным кодом метода, создается один раз
+    bb::BasicBlock* entryBB();
+    bool hasLocal(const std::string& name) const;
 
+    // слоты параметров фиксированы, остальные 
+    // назначаются в finalize с учетом живучести
     void createLocal(const std::string& name, 
-        std::uint16_t size);
-    std::uint16_t localIdx(const std::string& name);
+        std::uint16_t size, bool isParam = false);
 
     void insertInstr(bb::BasicBlock* bb, instr::Instr instr);
     void insertBranch(
@@ -64,12 +76,24 @@ public:
 
     const std::string& name() const noexcept override;
 
+    void setLayoutMode(codegen::LayoutMode mode) noexcept;
+    // адреса bb, смещения переходов и длина атрибута
+    void finalize();
+
 public:
-    void printBytes(std::ostream& out) const override;
+    // throw exception, if called before finalize
+    void printBytes(utility::ByteSink& out) const override;
 
 private:
+    void layoutChanged_();
+    // живучесть по cfg, локальные с непересекающимися
+    // диапазонами жизни делят слот
+    void allocLocals_();
+    // адреса bb с релаксацией далеких переходов
     void calcBBAddr_();
     void calcSelfLen_();
+    // обход cfg с распространением глубины стека
+    void calcMaxStack_();
     
     std::uint16_t maxStack_() const;
     std::uint16_t maxLocals_() const;
@@ -80,16 +104,24 @@ private:
     
 private:
     std::vector<std::unique_ptr<bb::BasicBlock>>code_;
+    bb::BasicBlock* entry_ = nullptr;
     // TODO: exception table 
     // TODO: attrs
 
     // class internal
-    std::map<std::string, 
-    //                 idx             sz
-        std::pair<std::uint16_t, std::uint16_t>> locals_;
+    //                     номер в localsIdxSz_
+    std::map<std::string, std::uint32_t> locals_;
 
+    //                    idx             sz
     std::vector<std::pair<std::uint16_t, std::uint16_t>> localsIdxSz_;
+    std::uint32_t paramsCnt_ = 0;
     static const std::string name_;
+
+    codegen::LayoutMode layoutMode_ = codegen::LayoutMode::DEFERRED;
+    bool layoutDirty_ = true;
+    std::uint32_t codeLen__ = 0;
+    std::uint16_t maxStack__ = 0;
+    std::uint16_t maxLocals__ = 0;
 };
 
 } // namespace jvm_attribute
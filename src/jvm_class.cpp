@@ -16,34 +16,38 @@ JVMClass::JVMClass(
     , nameIdx_(cp_->addClass(name.toString()))
 {}
 
-void JVMClass::printBytes(std::ostream& out) const {
-    utility::printBytes(out, 
-        utility::reverse(0xCAFEBABE));
+void JVMClass::optimize(peephole::Peephole& peephole) {
+    for (auto&& m : methods_) {
+        m->optimize(peephole);
+    }
+}
 
-    utility::printBytes(out, 
-        utility::reverse(minorV_));
-    utility::printBytes(out, 
-        utility::reverse(majorV_));
+void JVMClass::finalize() {
+    for (auto&& m : methods_) {
+        m->finalize();
+    }
+}
 
-    utility::printBytes(out, 
-        utility::reverse(cp_->size()));
+void JVMClass::printBytes(utility::ByteSink& out) const {
+    out.put(0xCAFEBABE);
+
+    out.put(minorV_);
+    out.put(majorV_);
+
+    out.put(cp_->size());
     cp_->printBytes(out);
     
-    utility::printBytes(out, 
-        utility::reverse(accf_));
+    out.put(accf_);
     
-    utility::printBytes(out, 
-        utility::reverse(nameIdx_));
+    out.put(nameIdx_);
 
-    utility::printBytes(out, 
-        utility::reverse(parentIdx_));
+    out.put(parentIdx_);
 
-    utility::printBytes(out, std::uint16_t(0)); // interface count
+    out.put(std::uint16_t(0)); // interface count
 
     auto fieldsCount =
          static_cast<std::uint16_t>(fields_.size()); 
-    utility::printBytes(out, 
-        utility::reverse(fieldsCount));
+    out.put(fieldsCount);
     
     for (auto&& f : fields_) {
         f->printBytes(out);
@@ -51,8 +55,7 @@ void JVMClass::printBytes(std::ostream& out) const {
     
     auto methodsCount =
          static_cast<std::uint16_t>(methods_.size()); 
-    utility::printBytes(out, 
-        utility::reverse(methodsCount));
+    out.put(methodsCount);
     
     for (auto&& m : methods_) {
         m->printBytes(out);
@@ -60,14 +63,19 @@ void JVMClass::printBytes(std::ostream& out) const {
     
     auto attrsCount =
          static_cast<std::uint16_t>(attrs_.size()); 
-    utility::printBytes(out, 
-        utility::reverse(attrsCount));
+    out.put(attrsCount);
 
     for (auto&& a : attrs_) {
         a->printBytes(out);
     }
 }
 
+std::vector<std::byte> JVMClass::bytes() const {
+    utility::ByteSink out;
+    printBytes(out);
+    return out.release();
+}
+
 constant_pool::SharedPtrJVMCP JVMClass::cp() {
     return cp_;
 }
@@ -84,15 +92,14 @@ void JVMClass::setParent(
     std::weak_ptr<JVMClass> par) 
 {
     auto lock = par.lock();
-    auto [ok, idx] = 
-        cp_->getClassIdx(lock->name());    
-    if (!ok) {
-        idx = cp_->addClass(lock->name());
-    }
-    parentIdx_ = idx;
+    parentIdx_ = cp_->addClass(lock->name());
     parent_ = par;
 }
 
+std::weak_ptr<JVMClass> JVMClass::parent() const {
+    return parent_;
+}
+
 void JVMClass::addAttr(
     std::shared_ptr<jvm_attribute::IAttribute> attr)
 {
@@ -140,10 +147,35 @@ JVMClass::addMethod(
     return method;
 }
 
+std::size_t JVMClass::methodCount() const noexcept {
+    return methods_.size();
+}
+
+void JVMClass::moveMethod(
+    class_member::SharedPtrMethod method,
+    jvm_class::SharedPtrJVMClass to)
+{
+    std::erase(methods_, method);
+    classNMethods_[this].erase(method.get());
+
+    method->moveTo(to);
+    to->methods_.push_back(method);
+    to->classNMethods_[to.get()][method.get()] = method->selfClassRef();
+
+    if (method->referenced()) {
+        auto stub = addMethod(
+            method->methodName(), method->methodType(), true);
+        stub->addFlag(codegen::AccessFlag::ACC_PUBLIC);
+        stub->addFlag(codegen::AccessFlag::ACC_STATIC);
+        stub->createForwarding(method);
+    }
+}
+
 std::uint16_t JVMClass::methodRef(
     class_member::SharedPtrMethod method) 
 {
     auto otherClsLock = method->cls();
+    method->markReferenced();
 
     if (!classNMethods_[otherClsLock.get()].contains(method.get())) {   
         auto name = cp_->addUtf8Name(method->methodName());
@@ -187,12 +219,7 @@ std::uint16_t JVMClass::linkThisClassNOtherClass_(
         return nameIdx_;
     }
 
-    auto&& [ok, otherClsName] = cp_->getClassIdx(otherClass->name());
-    if (!ok) {
-        otherClsName = cp_->addClass(otherClass->name());
-    }
-
-    return otherClsName;
+    return cp_->addClass(otherClass->name());
 }
 
 } // namespace jvm_class 
\ No newline at end of file
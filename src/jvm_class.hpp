@@ -17,7 +17,13 @@ public:
         std::uint16_t minorV);
 
 public:
-    void printBytes(std::ostream& out) const;
+    // peephole для всех методов
+    void optimize(peephole::Peephole& peephole);
+    // раскладка кода всех методов, вызывается перед printBytes
+    void finalize();
+    void printBytes(utility::ByteSink& out) const;
+    // содержимое .class без записи в файл
+    std::vector<std::byte> bytes() const;
 
 public:
     constant_pool::SharedPtrJVMCP cp();
@@ -27,6 +33,7 @@ public:
         return shared_from_this(); 
     }
     void setParent(std::weak_ptr<JVMClass> par);
+    std::weak_ptr<JVMClass> parent() const;
     void addAttr(std::shared_ptr<jvm_attribute::IAttribute> attr);
     void addAccesFlag(codegen::AccessFlag accf);
 
@@ -41,6 +48,13 @@ public:
         descriptor::JVMMethodDescriptor type,
         bool isStatic = false,
         const std::string& thisName = "this");
+    std::size_t methodCount() const noexcept;
+    // переносит статический метод, у которого еще нет кода, в to;
+    // если на метод уже ссылались через этот класс, 
+    // здесь остается переходник с тем же именем
+    void moveMethod(
+        class_member::SharedPtrMethod method,
+        jvm_class::SharedPtrJVMClass to);
 
 public:
     std::uint16_t methodRef(class_member::SharedPtrMethod method);
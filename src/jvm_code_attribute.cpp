@@ -2,9 +2,88 @@
 
 #include "bits_utility.hpp"
 
+#include <algorithm>
+#include <bit>
 #include <limits>
 #include <cstdint>
 
+namespace {
+
+bool usesLocal(instr::OpCode op) {
+    using O = instr::OpCode;
+    switch (op) {
+        case O::iload: case O::lload: case O::fload: 
+        case O::dload: case O::aload: case O::iinc: 
+        case O::ret:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool definesLocal(instr::OpCode op) {
+    using O = instr::OpCode;
+    switch (op) {
+        case O::istore: case O::lstore: case O::fstore: 
+        case O::dstore: case O::astore: case O::iinc:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// множество локальных переменных
+class LocalSet {
+public:
+    explicit LocalSet(std::size_t n) : 
+        words_((n + 63) / 64, 0) 
+    {}
+
+    void set(std::uint32_t v) { 
+        words_[v / 64] |= std::uint64_t(1) << (v % 64); 
+    }
+
+    void reset(std::uint32_t v) { 
+        words_[v / 64] &= ~(std::uint64_t(1) << (v % 64)); 
+    }
+
+    bool test(std::uint32_t v) const { 
+        return words_[v / 64] >> (v % 64) & 1; 
+    }
+
+    // true, если множество изменилось
+    bool unite(const LocalSet& other) {
+        bool changed = false;
+        for (std::size_t i = 0; i < words_.size(); ++i) {
+            auto w = words_[i] | other.words_[i];
+            changed |= w != words_[i];
+            words_[i] = w;
+        }
+        return changed;
+    }
+
+    void subtract(const LocalSet& other) {
+        for (std::size_t i = 0; i < words_.size(); ++i) {
+            words_[i] &= ~other.words_[i];
+        }
+    }
+
+    template <class F>
+    void forEach(F f) const {
+        for (std::size_t i = 0; i < words_.size(); ++i) {
+            for (auto w = words_[i]; w; w &= w - 1) {
+                f(static_cast<std::uint32_t>(
+                    i * 64 + std::countr_zero(w)));
+            }
+        }
+    }
+
+private:
+    std::vector<std::uint64_t> words_;
+};
+
+} // namespace
+
 namespace jvm_attribute {
 
 CodeAttr::CodeAttr(constant_pool::SharedPtrJVMCP cp) : 
@@ -18,8 +97,26 @@ bb::BasicBlock* CodeAttr::createBB() {
     return code_.back().get();
 }
 
+bb::BasicBlock* CodeAttr::entryBB() {
+    if (entry_) {
+        return entry_;
+    }
+    createBB();
+    std::rotate(code_.begin(), std::prev(code_.end()), code_.end());
+    for (std::size_t i = 0; i < code_.size(); ++i) {
+        code_[i]->id_ = static_cast<int>(i);
+    }
+    entry_ = code_.front().get();
+    layoutChanged_();
+    return entry_;
+}
+
+bool CodeAttr::hasLocal(const std::string& name) const {
+    return locals_.contains(name);
+}
+
 void CodeAttr::createLocal(
-    const std::string& name, std::uint16_t size) 
+    const std::string& name, std::uint16_t size, bool isParam) 
 {
     std::uint16_t preIdx = 0;
     std::uint16_t preSz = 0;
@@ -27,6 +124,10 @@ void CodeAttr::createLocal(
     if (locals_.contains(name)) {
         return;
     }
+    if (isParam && paramsCnt_ != localsIdxSz_.size()) {
+        throw std::logic_error("Parameter " + name + 
+                               " is created after local variables");
+    }
     
     if (!localsIdxSz_.empty()) {
         preIdx = localsIdxSz_.back().first;
@@ -34,26 +135,19 @@ void CodeAttr::createLocal(
     }
 
     auto idxSz = std::make_pair(preIdx + preSz, size);
+    locals_[name] = localsIdxSz_.size();
     localsIdxSz_.push_back(idxSz);
-    locals_[name] = idxSz;
-    calcSelfLen_();
-}
-
-std::uint16_t CodeAttr::localIdx(const std::string& name) {
-    auto it = locals_.find(name);
-    if (it == locals_.end()) {
-        throw std::logic_error(
-            "There is no local variable " + name);
+    if (isParam) {
+        ++paramsCnt_;
     }
-    return (it->second).first;
+    layoutChanged_();
 }
 
 void CodeAttr::insertInstr(
     bb::BasicBlock* bb, instr::Instr instr)
 {  
     bb->insertInstr(std::move(instr));
-    calcBBAddr_(); 
-    calcSelfLen_();
+    layoutChanged_();
 }
 
 void CodeAttr::insertBranch(
@@ -67,8 +161,7 @@ void CodeAttr::insertBranch(
     }
     checBBThenThrow_(from);
     from->insertBranch(op, to);    
-    calcBBAddr_(); 
-    calcSelfLen_();
+    layoutChanged_();
 }
 
 void CodeAttr::instertInstrWithLocal(
@@ -83,52 +176,202 @@ void CodeAttr::instertInstrWithLocal(
         throw std::logic_error(
             "There is no local variable " + name);
     }
-    auto [idx, _] = it->second;
-    std::unique_ptr<instr::Instr> ins;
-    if (idx > std::numeric_limits<std::uint8_t>::max()) {
-        ins.reset(
-            new instr::Instr(instr::OpCode::wide));
-        ins->pushByte(
-            static_cast<std::uint8_t>(op));
-        ins->pushTwoBytes(idx);
-    } else {
-        ins.reset(
-            new instr::Instr(op));
-        ins->pushByte(
-            static_cast<std::uint8_t>(idx));
-    }
+    instr::Instr ins(op);
+    ins.setLocal(it->second);
     for (auto b : bytes) {
-        ins->pushByte(b);
+        ins.pushByte(b);
     }
-    bb->insertInstr(*ins);
-    calcBBAddr_();
-    calcSelfLen_();
+    bb->insertInstr(std::move(ins));
+    layoutChanged_();
 }
 
 const std::string& CodeAttr::name() const noexcept {
     return name_;
 }
 
-void CodeAttr::printBytes(std::ostream& out) const {
+void CodeAttr::setLayoutMode(codegen::LayoutMode mode) noexcept {
+    layoutMode_ = mode;
+}
+
+void CodeAttr::finalize() {
+    if (!layoutDirty_) {
+        return;
+    }
+    allocLocals_();
+    calcBBAddr_();
+    calcSelfLen_();
+    calcMaxStack_();
+    layoutDirty_ = false;
+}
+
+void CodeAttr::printBytes(utility::ByteSink& out) const {
+    if (layoutDirty_) {
+        throw std::logic_error("Code attribute is printed" 
+                               " before finalize");
+    }
     IAttribute::printBytes(out);
-    utility::printBytes(out, 
-        utility::reverse(maxStack_()));
-    utility::printBytes(out, 
-        utility::reverse(maxLocals_()));
-    utility::printBytes(out, 
-        utility::reverse(codeLen_()));
+    out.put(maxStack_());
+    out.put(maxLocals_());
+    out.put(codeLen_());
     for (auto&& bb : code_) {
         bb->printBytes(out);
     }
-    utility::printBytes(out, std::uint16_t(0)); // TODO: exception_table
-    utility::printBytes(out, std::uint16_t(0)); // TODO: attribute_count
+    out.put(std::uint16_t(0)); // TODO: exception_table
+    out.put(std::uint16_t(0)); // TODO: attribute_count
 }
 
-void CodeAttr::calcBBAddr_() {
-    std::uint32_t idx = 0;
+void CodeAttr::layoutChanged_() {
+    layoutDirty_ = true;
+    // прежнее поведение: только адреса bb и длина атрибута,
+    // локальные и стек - все равно в finalize
+    if (codegen::LayoutMode::EAGER == layoutMode_) {
+        calcBBAddr_();
+        calcSelfLen_();
+    }
+}
+
+void CodeAttr::allocLocals_() {
+    auto n = localsIdxSz_.size();
+    auto bbCnt = code_.size();
+
+    // use/def для каждого bb
+    std::vector<LocalSet> use(bbCnt, LocalSet(n));
+    std::vector<LocalSet> def(bbCnt, LocalSet(n));
+    LocalSet used(n);
+    for (auto&& bb : code_) {
+        auto id = bb->id();
+        for (auto&& i : bb->instrs_) {
+            auto v = i.local();
+            if (!v) {
+                continue;
+            }
+            used.set(*v);
+            if (usesLocal(i.opCode()) && !def[id].test(*v)) {
+                use[id].set(*v);
+            }
+            if (definesLocal(i.opCode())) {
+                def[id].set(*v);
+            }
+        }
+    }
+
+    // in = use | (out - def), out = U in(succ)
+    std::vector<LocalSet> in(bbCnt, LocalSet(n));
+    std::vector<LocalSet> out(bbCnt, LocalSet(n));
+    for (bool changed = true; changed; ) {
+        changed = false;
+        for (auto it = code_.rbegin(); it != code_.rend(); ++it) {
+            auto&& bb = *it;
+            auto id = bb->id();
+            for (auto to : bb->branches_) {
+                out[id].unite(in[to->id()]);
+            }
+            std::size_t next = id + 1;
+            if (bb->fallsThrough() && next < bbCnt) {
+                out[id].unite(in[next]);
+            }
+            auto cur = out[id];
+            cur.subtract(def[id]);
+            cur.unite(use[id]);
+            changed |= in[id].unite(cur);
+        }
+    }
+
+    // граф конфликтов: определяемая переменная конфликтует 
+    // со всеми живыми в точке определения
+    std::vector<LocalSet> conflicts(n, LocalSet(n));
+    auto conflict = [&conflicts] (std::uint32_t v, const LocalSet& live) {
+        live.forEach([&conflicts, v] (std::uint32_t u) {
+            if (u != v) {
+                conflicts[v].set(u);
+                conflicts[u].set(v);
+            }
+        });
+    };
+    for (auto&& bb : code_) {
+        auto live = out[bb->id()];
+        for (auto it = bb->instrs_.rbegin(); 
+             it != bb->instrs_.rend(); ++it) 
+        {
+            auto v = it->local();
+            if (!v) {
+                continue;
+            }
+            if (definesLocal(it->opCode())) {
+                conflict(*v, live);
+                live.reset(*v);
+            }
+            if (usesLocal(it->opCode())) {
+                live.set(*v);
+            }
+        }
+    }
+    // живые на входе в метод (читаются до записи)
+    if (bbCnt) {
+        in.front().forEach([&] (std::uint32_t v) {
+            conflict(v, in.front());
+        });
+    }
+
+    // слоты параметров фиксированы и не переиспользуются, 
+    // остальным - первый свободный от конфликтующих диапазон
+    std::uint32_t paramsEnd = 0;
+    for (std::uint32_t p = 0; p < paramsCnt_; ++p) {
+        auto [idx, sz] = localsIdxSz_[p];
+        paramsEnd = std::max<std::uint32_t>(paramsEnd, idx + sz);
+    }
+    std::uint32_t maxLocals = paramsEnd;
+    for (std::uint32_t v = paramsCnt_; v < n; ++v) {
+        auto&& [idx, sz] = localsIdxSz_[v];
+        if (!used.test(v)) {
+            continue;
+        }
+        auto slot = paramsEnd;
+        for (bool busy = true; busy; ) {
+            busy = false;
+            conflicts[v].forEach([&] (std::uint32_t u) {
+                auto [uIdx, uSz] = localsIdxSz_[u];
+                if (paramsCnt_ <= u && u < v && used.test(u) &&
+                    slot < std::uint32_t(uIdx + uSz) && 
+                    uIdx < slot + sz) 
+                {
+                    slot = uIdx + uSz;
+                    busy = true;
+                }
+            });
+        }
+        if (slot + sz > std::numeric_limits<std::uint16_t>::max()) {
+            throw std::logic_error("Too many local variables");
+        }
+        idx = static_cast<std::uint16_t>(slot);
+        maxLocals = std::max<std::uint32_t>(maxLocals, slot + sz);
+    }
+    maxLocals__ = static_cast<std::uint16_t>(maxLocals);
+
     for (auto&& bb : code_) {
-        bb->setStartOpCodeIdx(idx);
-        idx += bb->len();
+        for (auto&& i : bb->instrs_) {
+            if (auto v = i.local()) {
+                i.setSlot(localsIdxSz_[*v].first);
+            }
+        }
+    }
+}
+
+void CodeAttr::calcBBAddr_() {
+    // релаксация переходов: расширение только увеличивает длины,
+    // поэтому итерации сходятся
+    for (bool changed = true; changed; ) {
+        std::uint32_t idx = 0;
+        for (auto&& bb : code_) {
+            bb->setStartOpCodeIdx(idx);
+            idx += bb->len();
+        }
+        codeLen__ = idx;
+
+        changed = false;
+        for (auto&& bb : code_) {
+            changed |= bb->relaxBranches();
+        }
     }
 }
 
@@ -136,29 +379,46 @@ void CodeAttr::calcSelfLen_() {
     IAttribute::setAttrLent(selfLen_());
 }
 
-std::uint16_t CodeAttr::maxStack_() const {
-    std::uint16_t stack = 0;
-    for (auto&& bb : code_) {
-        stack += bb->stackSize();
+void CodeAttr::calcMaxStack_() {
+    // глубина стека на входе в bb, -1 - bb еще не достигнут
+    std::vector<std::int32_t> entry(code_.size(), -1);
+    std::vector<bb::BasicBlock*> work;
+    std::vector<std::pair<bb::BasicBlock*, std::int32_t>> succ;
+    std::uint16_t max = 0;
+    if (!code_.empty()) {
+        entry[0] = 0;
+        work.push_back(code_.front().get());
     }
-    return stack;
+    while (!work.empty()) {
+        auto bb = work.back();
+        work.pop_back();
+        auto depth = entry[bb->id()];
+        succ.clear();
+        max = std::max(max, bb->stackSize(depth, succ));
+        std::size_t next = bb->id() + 1;
+        if (bb->fallsThrough() && next < code_.size()) {
+            succ.emplace_back(code_[next].get(), depth);
+        }
+        for (auto&& [to, d] : succ) {
+            if (d > entry[to->id()]) {
+                entry[to->id()] = d;
+                work.push_back(to);
+            }
+        }
+    }
+    maxStack__ = max;
+}
+
+std::uint16_t CodeAttr::maxStack_() const {
+    return maxStack__;
 }
 
 std::uint16_t CodeAttr::maxLocals_() const {
-    std::uint16_t locals = 0;
-    for (auto&& pair : locals_) {
-        auto&& [_, sz] = pair.second;
-        locals += sz;
-    }
-    return locals;
+    return maxLocals__;
 }
 
 std::uint32_t CodeAttr::codeLen_() const {
-    std::uint32_t len = 0;
-    for (auto&& bb : code_) {
-        len += bb->len();
-    }
-    return len;
+    return codeLen__;
 }
 
 std::uint32_t CodeAttr::selfLen_() const {
@@ -0,0 +1,32 @@
+#pragma once
+
+#if !defined(yyFlexLexerOnce)
+#include <FlexLexer.h>
+#endif
+
+#include <istream>
+#include <string>
+
+#include "parser.hpp"
+#include "helper.hpp"
+
+namespace lexer {
+
+// лексер единицы компиляции: позиция, yylval и ошибки
+// пишутся в ее контекст, а не в глобальные переменные
+class Lexer : public yyFlexLexer {
+public:
+    Lexer(std::istream* in, helper::ParseContext& ctx);
+
+    int yylex() override;
+
+    helper::ParseContext& context() noexcept;
+
+private:
+    void handleLexicalError_(std::string msg, std::string err = "");
+
+private:
+    helper::ParseContext& ctx_;
+};
+
+} // namespace lexer
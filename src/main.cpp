@@ -1,12 +1,20 @@
 #include <iostream>
 #include <exception>
+#include <charconv>
+#include <optional>
 #include <fstream>
 #include <string_view>
 #include <algorithm>
 #include <filesystem>
-
-#include <FlexLexer.h>
-
+#include <functional>
+#include <iterator>
+#include <map>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#include "lexer.hpp"
 #include "helper.hpp"
 #include "parser.hpp"
 #include "graphviz.hpp"
@@ -16,6 +24,7 @@
 #include "semantics_part.hpp"
 #include "codegen.hpp"
 #include "ada_codegen.hpp"
+#include "alloc_stats.hpp"
 
 namespace codegen {
     JavaBCCodegen cg(49, 0);
@@ -30,51 +39,160 @@ void printErrors() {
     }
 }
 
-bool parseProgram(std::filesystem::path path) {
+// результат разбора модуля: .adb и/или .ads
+struct ParsedModule {
+    std::vector<std::unique_ptr<helper::ParseContext>> units;
+    // with-модули в порядке появления
+    std::vector<std::string> imports;
+    bool failed = false;
+    std::string notFound;
+    std::exception_ptr exception;
+};
+
+// -> false, если файла нет
+bool parseUnit(const std::filesystem::path& path,
+               const std::string& mdl,
+               const std::string& ext,
+               ParsedModule& res,
+               const std::function<void(const std::string&)>& onImport)
+{
+    std::ifstream ifs(path, std::ios::in);
+    if (!ifs.is_open()) {
+        return false;
+    }
+    auto&& ctx = *res.units.emplace_back(
+        std::make_unique<helper::ParseContext>());
+    ctx.moduleName = mdl;
+    ctx.fileName = path.string();
+    ctx.fileExtension = ext;
+    ctx.onImport = onImport;
+    lexer::Lexer lexer(&ifs, ctx);
+    yy::parser p(&lexer, ctx);
+    // p.set_debug_level(1);
+    if (p.parse()) {
+        res.failed = true;
+    }
+    return true;
+}
+
+void parseModule(std::filesystem::path path,
+                 const std::string& mdl,
+                 ParsedModule& res,
+                 const std::function<void(const std::string&)>& schedule)
+{
+    auto onImport = [&] (const std::string& imp) {
+        res.imports.push_back(imp);
+        schedule(imp);
+    };
+    bool anyOpened = false;
+    path.replace_filename(mdl + ".adb");
+    anyOpened |= parseUnit(path, mdl, "adb", res, onImport);
+    if (res.failed) {
+        return;
+    }
+    path.replace_filename(mdl + ".ads");
+    anyOpened |= parseUnit(path, mdl, "ads", res, onImport);
+
+    if (!anyOpened) {
+        std::stringstream ss;
+        ss << "Can`t open file ";
+        ss << path << "or .adb"; 
+        ss << " or file doesn't exist";
+        res.notFound = ss.str();
+    }
+}
+
+// модули разбираются пулом потоков по мере того, как находятся with;
+// результаты затем собираются в порядке обхода в ширину от корня -
+// том же, что и при разборе в один поток
+bool parseProgram(std::filesystem::path path, unsigned jobs) {
     using namespace helper;
 
-    while (!modulesForPars.empty()) {
-        std::string mdl = modulesForPars.front();
-        modulesForPars.pop();
+    std::vector<std::string> roots;
+    for (; !modulesForPars.empty(); modulesForPars.pop()) {
+        auto mdl = modulesForPars.front();
         utility::toLower(mdl);
+        roots.push_back(mdl);
+    }
+    auto imported = allModules;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::queue<std::string> pending;
+    std::map<std::string, ParsedModule> parsed;
+    std::size_t inFlight = 0;
+
+    auto schedule = [&] (const std::string& mdl) {
+        std::lock_guard lock(mtx);
+        if (allModules.insert(mdl).second) {
+            pending.push(mdl);
+            cv.notify_one();
+        }
+    };
+    for (auto&& mdl : roots) {
+        schedule(mdl);
+    }
 
-        bool anyOpened = false;
-        path.replace_filename(mdl + ".adb");
-        curModuleFileExtension = "adb";
-        std::ifstream ifs(path, std::ios::in);
-        if (ifs.is_open()) {
-            curModuleName = mdl;
-            curModuleFileName = path;
-            yyFlexLexer lexer(&ifs);
-            yy::parser p(&lexer);
-            // p.set_debug_level(1);
-            anyOpened = true;
-            if(p.parse()) {
-                return false;
+    auto worker = [&] {
+        std::unique_lock lock(mtx);
+        while (true) {
+            cv.wait(lock, [&] { 
+                return !pending.empty() || 0 == inFlight; 
+            });
+            if (pending.empty()) {
+                break;
             }
-        } 
-
-        path.replace_filename(mdl + ".ads");
-        std::ifstream ifs2(path, std::ios::in);
-        curModuleFileExtension = "ads";
-        if (ifs2.is_open()) {
-            curModuleName = mdl;
-            curModuleFileName = path;
-            yyFlexLexer lexer(&ifs2);
-            yy::parser p(&lexer);
-            // p.set_debug_level(1);
-            anyOpened = true;
-            if(p.parse()) {
-                return false;
+            auto mdl = std::move(pending.front());
+            pending.pop();
+            auto&& res = parsed[mdl];
+            ++inFlight;
+            lock.unlock();
+            try {
+                parseModule(path, mdl, res, schedule);
+            } catch (...) {
+                res.exception = std::current_exception();
             }
+            lock.lock();
+            --inFlight;
+            cv.notify_all();
+        }
+    };
+    {
+        std::vector<std::jthread> pool;
+        for (unsigned i = 1; i < jobs; ++i) {
+            pool.emplace_back(worker);
         }
+        worker();
+    }
 
-        if (!anyOpened) {
-            std::stringstream ss;
-            ss << "Can`t open file ";
-            ss << path << "or .adb"; 
-            ss << " or file doesn't exist";
-            throw std::runtime_error(ss.str());
+    std::queue<std::string> order;
+    for (auto&& mdl : roots) {
+        if (imported.insert(mdl).second) {
+            order.push(mdl);
+        }
+    }
+    for (; !order.empty(); order.pop()) {
+        auto&& res = parsed.at(order.front());
+        for (auto&& unit : res.units) {
+            std::ranges::move(unit->errs, std::back_inserter(errs));
+        }
+        if (res.exception) {
+            std::rethrow_exception(res.exception);
+        }
+        if (res.failed) {
+            return false;
+        }
+        if (!res.notFound.empty()) {
+            throw std::runtime_error(res.notFound);
+        }
+        for (auto&& unit : res.units) {
+            modules.push_back(unit->module);
+            rightEnding = unit->rightEnding && rightEnding;
+        }
+        for (auto&& imp : res.imports) {
+            if (imported.insert(imp).second) {
+                order.push(imp);
+            }
         }
     }
 
@@ -91,8 +209,9 @@ void printAst() {
     gv->printDOT(std::cout);
 }
 
-int semanticAnalysis() {
+int semanticAnalysis(bool timePasses, unsigned jobs) {
     semantics::ADASementics sem;
+    sem.setJobs(jobs);
     auto EPC = // проверка на точку входа - процедуру
         std::make_shared<semantics_part::EntryPointCheck>();
     auto MNC = // проверка на соотв. имени файла и имени ед. комп.
@@ -123,33 +242,52 @@ int semanticAnalysis() {
         std::make_shared<semantics_part::CreateClassDeclaration>();
     auto OCSC = // проверка на наличие только одного типа ооп класса в параметрах подпрогр. 
         std::make_shared<semantics_part::OneClassInSubprogramCheck>();
+    // проверки деклараций идут совмещенными обходами (DeclWalk):
+    // в одном обходе - только независимые друг от друга
+    auto DW = std::make_shared<semantics_part::DeclWalk>();
+    DW->add(NCC, "NameConflictCheck");
+    DW->add(IVNCC, "InheritsVarNameConlflicCheck");
+    DW->add(OC, "OverloadCheck");
+    DW->add(SBDL, "SubprogBodyNDeclLinking");
+    // после CreateClassDeclaration
+    auto DWC = std::make_shared<semantics_part::DeclWalk>();
+    DWC->add(OCSC, "OneClassInSubprogramCheck");
     // линковка выражений и объявлений
     auto LE = std::make_shared<semantics_part::LinkExprs>();
     // проверка типов
     auto TC = std::make_shared<semantics_part::TypeCheck>();
+    // свертка констант
+    auto CF = std::make_shared<semantics_part::ConstantFolding>();
+    // копии рекордов, массивов и строк, которые можно не делать
+    auto CE = std::make_shared<semantics_part::CopyElision>();
+    // вынос инвариантной части индекса N-мерных массивов из циклов
+    auto LI = std::make_shared<semantics_part::LoopIndexing>();
     // расстановка полных квал. имен
     auto QNS = std::make_shared<semantics_part::QualifiedNameSet>();
 
-    sem.addPart(EPC);
-    sem.addPart(MNC);
-    sem.addPart(OLC);
-    sem.addPart(SIC);
-    sem.addPart(EMIC);
-    sem.addPart(GSC);
-    sem.addPart(CIC);
-    sem.addPart(NCC);
-    sem.addPart(PBDL);
-    sem.addPart(TNRT);
-    sem.addPart(IVNCC);
-    sem.addPart(OC);
-    sem.addPart(SBDL);
-    sem.addPart(CCD);
-    sem.addPart(OCSC);
-    sem.addPart(LE);
-    sem.addPart(TC);
-    sem.addPart(QNS);
+    sem.addPart(EPC, "EntryPointCheck");
+    sem.addPart(MNC, "ModuleNameCheck");
+    sem.addPart(OLC, "OneLevelWithCheck");
+    sem.addPart(SIC, "SelfImportCheck");
+    sem.addPart(EMIC, "ExistingModuleImportCheck");
+    sem.addPart(GSC, "GlobalSpaceCreation");
+    sem.addPart(CIC, "CircularImportCheck");
+    sem.addPart(PBDL, "PackBodyNDeclLinking");
+    sem.addPart(TNRT, "TypeNameToRealType");
+    sem.addPart(DW, DW->name());
+    sem.addPart(CCD, "CreateClassDeclaration");
+    sem.addPart(DWC, DWC->name());
+    sem.addPart(LE, "LinkExprs");
+    sem.addPart(TC, "TypeCheck");
+    sem.addPart(CF, "ConstantFolding");
+    sem.addPart(CE, "CopyElision");
+    sem.addPart(LI, "LoopIndexing");
+    sem.addPart(QNS, "QualifiedNameSet");
 
     auto[ok, msg] = sem.analyse(helper::modules);
+    if (timePasses) {
+        sem.printStats(std::cerr);
+    }
     if (!ok) {
         std::cerr << msg << std::endl;
         return 1;
@@ -177,7 +315,7 @@ void addAdaStdLib(
     auto plf = codegen::InnerSubprograms->addMethod(PutLine->name(), desc, true);
     auto* plfBB = plf->createBB();
     plf->createAload(plfBB, "str");
-    plf->createInvokestatic(plfBB, codegen::AdaUtilityPrintStringBuilder);
+    plf->createInvokestatic(plfBB, codegen::AdaUtilityPrintString);
     plf->createReturn(plfBB);
 
     plf->addFlag(codegen::java_bytecode_codegen::AccessFlag::ACC_PUBLIC);
@@ -199,9 +337,9 @@ void addAdaStdLib(
     auto giDesc = GetInt->desc();
     auto gif = codegen::InnerSubprograms->addMethod(GetInt->name(), giDesc, true);
     auto* gifBB = gif->createBB();
-    gif->createAload(gifBB, "x");
+    gif->createIload(gifBB, "x");
     gif->createInvokestatic(gifBB, codegen::AdaUtilityReadInt);
-    gif->createReturn(gifBB);
+    gif->createIreturn(gifBB);
 
     gif->addFlag(codegen::java_bytecode_codegen::AccessFlag::ACC_PUBLIC);
     gif->addFlag(codegen::java_bytecode_codegen::AccessFlag::ACC_STATIC);
@@ -222,9 +360,9 @@ void addAdaStdLib(
     auto gbDesc = GetBool->desc();
     auto gbf = codegen::InnerSubprograms->addMethod(GetBool->name(), gbDesc, true);
     auto* gbfBB = gbf->createBB();
-    gbf->createAload(gbfBB, "x");
+    gbf->createIload(gbfBB, "x");
     gbf->createInvokestatic(gbfBB, codegen::AdaUtilityReadBool);
-    gbf->createReturn(gbfBB);
+    gbf->createIreturn(gbfBB);
 
     gbf->addFlag(codegen::java_bytecode_codegen::AccessFlag::ACC_PUBLIC);
     gbf->addFlag(codegen::java_bytecode_codegen::AccessFlag::ACC_STATIC);
@@ -244,9 +382,9 @@ void addAdaStdLib(
     auto gfDesc = GetFloat->desc();
     auto gff = codegen::InnerSubprograms->addMethod(GetFloat->name(), gfDesc, true);
     auto* gffBB = gff->createBB();
-    gff->createAload(gffBB, "x");
+    gff->createFload(gffBB, "x");
     gff->createInvokestatic(gffBB, codegen::AdaUtilityReadFloat);
-    gff->createReturn(gffBB);
+    gff->createFreturn(gffBB);
 
     gff->addFlag(codegen::java_bytecode_codegen::AccessFlag::ACC_PUBLIC);
     gff->addFlag(codegen::java_bytecode_codegen::AccessFlag::ACC_STATIC);
@@ -289,9 +427,9 @@ void addAdaStdLib(
     auto gcDesc = GetChar->desc();
     auto gcf = codegen::InnerSubprograms->addMethod("getc", gcDesc, true);
     auto* gcfBB = gcf->createBB();
-    gcf->createAload(gcfBB, "x");
+    gcf->createIload(gcfBB, "x");
     gcf->createInvokestatic(gcfBB, codegen::AdaUtilityReadChar);
-    gcf->createReturn(gcfBB);
+    gcf->createIreturn(gcfBB);
 
     gcf->addFlag(codegen::java_bytecode_codegen::AccessFlag::ACC_PUBLIC);
     gcf->addFlag(codegen::java_bytecode_codegen::AccessFlag::ACC_STATIC);
@@ -322,6 +460,19 @@ void addAdaStdLib(
         "ada.text_io", "ada.text_io.ads", "ads");
     helper::modules.push_back(mod);
 }
+
+constexpr unsigned maxJobs = 1024;
+
+// значение --xxx-jobs=N: целое от 1 до maxJobs, иначе nullopt
+std::optional<unsigned> parseJobsOpt(std::string_view value) {
+    unsigned n = 0;
+    auto end = value.data() + value.size();
+    auto [ptr, ec] = std::from_chars(value.data(), end, n);
+    if (std::errc() != ec || end != ptr || 0 == n || n > maxJobs) {
+        return std::nullopt;
+    }
+    return n;
+}
 } // namespace
 
 int yyFlexLexer::yywrap() { return 1; }
@@ -333,7 +484,15 @@ int main(int argc, char** argv) /*try*/ {
         std::cout << 
         R"(Help:
     -h : help
-    --pAst-before-semantics : print ast before semantics analysis)" 
+    --pAst-before-semantics : print ast before semantics analysis
+    --no-peephole : disable peephole optimization of bytecode
+    --peephole-stats : print peephole rule hit counters
+    --cp-stats : print constant pool sizes per class
+    --time-passes : print time, visited nodes and allocations per semantic pass
+    --parse-jobs=N : parse modules on N threads, 1..1024 (default: all cores)
+    --sem-jobs=N : run module-local semantic passes on N threads, 1..1024 (default: 1)
+    --jar=out.jar : write all classes and AdaUtility into one runnable jar
+    --jar-stored : do not compress jar entries)" 
         << std::endl;
         return 0;
     }
@@ -390,6 +549,50 @@ int main(int argc, char** argv) /*try*/ {
         return 1;
     }
 
+    bool pAst = false;
+    bool peepholeStats = false;
+    bool cpStats = false;
+    bool timePasses = false;
+    std::string jarPath;
+    bool jarStored = false;
+    unsigned parseJobs = std::max(1u, std::thread::hardware_concurrency());
+    unsigned semJobs = 1;
+    for (int i = 2; i < argc; ++i) {
+        std::string_view opt(argv[i]);
+        if ("--pAst-before-semantics" == opt) {
+            pAst = true;
+        } else if ("--no-peephole" == opt) {
+            codegen::cg.peephole().setEnabled(false);
+        } else if ("--peephole-stats" == opt) {
+            peepholeStats = true;
+        } else if ("--cp-stats" == opt) {
+            cpStats = true;
+        } else if ("--time-passes" == opt) {
+            timePasses = true;
+            alloc_stats::setEnabled(true);
+        } else if (opt.starts_with("--parse-jobs=")) {
+            auto n = parseJobsOpt(opt.substr(13));
+            if (!n) {
+                std::cout << "Invalid " << opt << ": expected a number from 1 to " 
+                          << maxJobs << "; -h for help" << std::endl;
+                return 1;
+            }
+            parseJobs = *n;
+        } else if (opt.starts_with("--sem-jobs=")) {
+            auto n = parseJobsOpt(opt.substr(11));
+            if (!n) {
+                std::cout << "Invalid " << opt << ": expected a number from 1 to " 
+                          << maxJobs << "; -h for help" << std::endl;
+                return 1;
+            }
+            semJobs = *n;
+        } else if (opt.starts_with("--jar=")) {
+            jarPath = opt.substr(6);
+        } else if ("--jar-stored" == opt) {
+            jarStored = true;
+        }
+    }
+
     fs::path path(argv[1]);
     if (".adb" != path.extension()) {
         std::cout << "Usage ./jada file.adb; -h for help" << std::endl;
@@ -406,14 +609,12 @@ int main(int argc, char** argv) /*try*/ {
     codegen::initAdaUtilityNames();
     addAdaStdLib(helper::modules);
 
-    if (!parseProgram(path.remove_filename())) {
+    if (!parseProgram(path.remove_filename(), parseJobs)) {
         printErrors();
         return 1;
     }
         // TODO: delete
-    if (/* true || */ 3 == argc && 
-        std::string("--pAst-before-semantics") == argv[2]) 
-    {
+    if (/* true || */ pAst) {
         printAst();
     }
 
@@ -423,7 +624,7 @@ int main(int argc, char** argv) /*try*/ {
         return 1;
     }
 
-    int res = semanticAnalysis();
+    int res = semanticAnalysis(timePasses, semJobs);
     if (res != 0)  return res;
     // if (res == 0) {
     //     std::cout << "semantic analysis: OK\n"; // TODO: delete
@@ -431,7 +632,17 @@ int main(int argc, char** argv) /*try*/ {
     //     return res;
     // }
 
+    if (!jarPath.empty()) {
+        codegen::cg.setJarOutput(jarPath, jarStored ? 
+            jar::Compression::STORED : jar::Compression::DEFLATE);
+    }
     codegen::gen(helper::modules);
+    if (peepholeStats) {
+        codegen::cg.peephole().printStats(std::cerr);
+    }
+    if (cpStats) {
+        codegen::cg.printConstPoolStats(std::cerr);
+    }
 
     return 0;
 }
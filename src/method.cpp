@@ -1,10 +1,24 @@
 #include "method.hpp"
 
 #include "jvm_class.hpp"
+#include "peephole.hpp"
 
 #include <limits>
 #include <cstdint>
 
+namespace {
+
+instr::StackEffect invokeEffect(
+    const descriptor::JVMMethodDescriptor& type, 
+    bool hasReceiver)
+{
+    auto pop = type.paramsSize() + (hasReceiver ? 1 : 0);
+    return { static_cast<std::uint16_t>(pop), 
+             static_cast<std::uint16_t>(type.retSize()) };
+}
+
+} // namespace
+
 namespace class_member {
 
 using instr::OpCode;
@@ -37,11 +51,11 @@ JVMClassMethod::JVMClassMethod(
     }
 
     if (!isStatic) {
-        createLocalRef(thisName);
+        code_->createLocal(thisName, 1, true);
     }
 
     for (auto [name, sz] : type__.params()) {
-        code_->createLocal(name, sz);
+        code_->createLocal(name, sz, true);
     }
 }
 
@@ -49,6 +63,14 @@ bb::BasicBlock* JVMClassMethod::createBB() {
     return code_->createBB();
 }
 
+bb::BasicBlock* JVMClassMethod::entryBB() {
+    return code_->entryBB();
+}
+
+bool JVMClassMethod::hasLocal(const std::string& name) const {
+    return code_->hasLocal(name);
+}
+
 std::uint16_t JVMClassMethod::selfClassRef() const noexcept {
     return methodRef_;
 }
@@ -62,11 +84,79 @@ JVMClassMethod::methodName() const noexcept {
     return name__;
 }
 
+bool JVMClassMethod::referenced() const noexcept {
+    return referenced_;
+}
+
+void JVMClassMethod::markReferenced() noexcept {
+    referenced_ = true;
+}
+
+void JVMClassMethod::moveTo(std::weak_ptr<jvm_class::JVMClass> cls) {
+    auto lock = cls.lock();
+    auto cp = lock->cp();
+    rebind_(
+        cp->addUtf8Name(name__),
+        cp->addMethodDescriptor(type__),
+        cp);
+    auto nameNType = cp->addNameAndType(name(), type());
+    methodRef_ = cp->addMehodRef(lock->nameIdx(), nameNType);
+    selfClass_ = cls;
+}
+
+void JVMClassMethod::createForwarding(
+    std::shared_ptr<JVMClassMethod> target) 
+{
+    auto* bb = createBB();
+    auto&& descr = type__.toString();
+    auto&& params = type__.params();
+    std::size_t pos = 1;
+    for (std::size_t k = 0; ')' != descr[pos]; ++k) {
+        auto type = descr[pos];
+        while ('[' == descr[pos]) {
+            ++pos;
+        }
+        pos = 'L' == descr[pos] ? descr.find(';', pos) + 1 : pos + 1;
+
+        auto&& local = params.at(k).first;
+        switch (type) {
+            case 'J': createLload(bb, local); break;
+            case 'D': createDload(bb, local); break;
+            case 'F': createFload(bb, local); break;
+            case 'L': case '[': createAload(bb, local); break;
+            default: createIload(bb, local); break;
+        }
+    }
+    createInvokestatic(bb, target);
+    switch (descr[pos + 1]) {
+        case 'V': createReturn(bb); break;
+        case 'J': createLreturn(bb); break;
+        case 'D': createDreturn(bb); break;
+        case 'F': createFreturn(bb); break;
+        case 'L': case '[': createAreturn(bb); break;
+        default: createIreturn(bb); break;
+    }
+}
+
 const descriptor::JVMMethodDescriptor&
 JVMClassMethod::methodType() const noexcept {
     return type__;
 }
 
+void JVMClassMethod::setLayoutMode(
+    codegen::LayoutMode mode) noexcept 
+{
+    code_->setLayoutMode(mode);
+}
+
+void JVMClassMethod::optimize(peephole::Peephole& peephole) {
+    peephole.run(*code_);
+}
+
+void JVMClassMethod::finalize() {
+    code_->finalize();
+}
+
 void JVMClassMethod::createPop(bb::BasicBlock* bb) {
     code_->insertInstr(bb, OpCode::pop);
 }
@@ -186,201 +276,68 @@ void JVMClassMethod::createLocalRef(
 void JVMClassMethod::createAload(
     bb::BasicBlock* bb, const std::string& local) 
 {   
-    auto idx = code_->localIdx(local);
-    auto op = idx == 0 ? OpCode::aload_0 
-                : idx == 1 ? OpCode::aload_1 
-                : idx == 2 ? OpCode::aload_2
-                : idx == 3 ? OpCode::aload_3
-                : OpCode::aload; 
-
-    if (OpCode::aload == op) {
-        code_->instertInstrWithLocal(
-            bb, op, local
-        );
-    } else {
-        code_->insertInstr(bb, op);
-    }
+    code_->instertInstrWithLocal(bb, OpCode::aload, local);
 }
 
 void JVMClassMethod::createDload(
     bb::BasicBlock* bb, const std::string& local) 
 {
-    auto idx = code_->localIdx(local);
-    auto op = idx == 0 ? OpCode::dload_0 
-                : idx == 1 ? OpCode::dload_1 
-                : idx == 2 ? OpCode::dload_2
-                : idx == 3 ? OpCode::dload_3
-                : OpCode::dload; 
-
-    if (OpCode::dload == op) {
-        code_->instertInstrWithLocal(
-            bb, op, local
-        );
-    } else {
-        code_->insertInstr(bb, op);
-    }
+    code_->instertInstrWithLocal(bb, OpCode::dload, local);
 }
 
 void JVMClassMethod::createFload(
     bb::BasicBlock* bb, const std::string& local) 
 {
-    auto idx = code_->localIdx(local);
-    auto op = idx == 0 ? OpCode::fload_0 
-                : idx == 1 ? OpCode::fload_1 
-                : idx == 2 ? OpCode::fload_2
-                : idx == 3 ? OpCode::fload_3
-                : OpCode::fload; 
-
-    if (OpCode::fload == op) {
-        code_->instertInstrWithLocal(
-            bb, op, local
-        );
-    } else {
-        code_->insertInstr(bb, op);
-    }
+    code_->instertInstrWithLocal(bb, OpCode::fload, local);
 }
 
 void JVMClassMethod::createIload(
     bb::BasicBlock* bb, const std::string& local) 
 {
-    auto idx = code_->localIdx(local);
-    auto op = idx == 0 ? OpCode::iload_0 
-                : idx == 1 ? OpCode::iload_1 
-                : idx == 2 ? OpCode::iload_2
-                : idx == 3 ? OpCode::iload_3
-                : OpCode::iload; 
-
-    if (OpCode::iload == op) {
-        code_->instertInstrWithLocal(
-            bb, op, local
-        );
-    } else {
-        code_->insertInstr(bb, op);
-    }
+    code_->instertInstrWithLocal(bb, OpCode::iload, local);
 }
 
 void JVMClassMethod::createLload(
     bb::BasicBlock* bb, const std::string& local) 
 {
-    auto idx = code_->localIdx(local);
-    auto op = idx == 0 ? OpCode::lload_0 
-                : idx == 1 ? OpCode::lload_1 
-                : idx == 2 ? OpCode::lload_2
-                : idx == 3 ? OpCode::lload_3
-                : OpCode::lload;
-
-    if (OpCode::lload == op) {
-        code_->instertInstrWithLocal(
-            bb, op, local
-        );
-    } else {
-        code_->insertInstr(bb, op);
-    }
+    code_->instertInstrWithLocal(bb, OpCode::lload, local);
 }
 
 void JVMClassMethod::createAstore(
     bb::BasicBlock* bb, const std::string& local) 
 {   
-    auto idx = code_->localIdx(local);
-    auto op = idx == 0 ? OpCode::astore_0 
-                : idx == 1 ? OpCode::astore_1 
-                : idx == 2 ? OpCode::astore_2
-                : idx == 3 ? OpCode::astore_3
-                : OpCode::astore; 
-
-    if (OpCode::astore == op) {
-        code_->instertInstrWithLocal(
-            bb, op, local
-        );
-    } else {
-        code_->insertInstr(bb, op);
-    }
+    code_->instertInstrWithLocal(bb, OpCode::astore, local);
 }
 
 void JVMClassMethod::createDstore(
     bb::BasicBlock* bb, const std::string& local) 
 {
-    auto idx = code_->localIdx(local);
-    auto op = idx == 0 ? OpCode::dstore_0 
-                : idx == 1 ? OpCode::dstore_1 
-                : idx == 2 ? OpCode::dstore_2
-                : idx == 3 ? OpCode::dstore_3
-                : OpCode::dstore; 
-
-    if (OpCode::dstore == op) {
-        code_->instertInstrWithLocal(
-            bb, op, local
-        );
-    } else {
-        code_->insertInstr(bb, op);
-    }
+    code_->instertInstrWithLocal(bb, OpCode::dstore, local);
 }
 
 void JVMClassMethod::createFstore(
     bb::BasicBlock* bb, const std::string& local) 
 {
-    auto idx = code_->localIdx(local);
-    auto op = idx == 0 ? OpCode::fstore_0 
-                : idx == 1 ? OpCode::fstore_1 
-                : idx == 2 ? OpCode::fstore_2
-                : idx == 3 ? OpCode::fstore_3
-                : OpCode::fstore; 
-
-    if (OpCode::fstore == op) {
-        code_->instertInstrWithLocal(
-            bb, op, local
-        );
-    } else {
-        code_->insertInstr(bb, op);
-    }
+    code_->instertInstrWithLocal(bb, OpCode::fstore, local);
 }
 
 void JVMClassMethod::createIstore(
     bb::BasicBlock* bb, const std::string& local) 
 {
-    auto idx = code_->localIdx(local);
-    auto op = idx == 0 ? OpCode::istore_0 
-                : idx == 1 ? OpCode::istore_1 
-                : idx == 2 ? OpCode::istore_2
-                : idx == 3 ? OpCode::istore_3
-                : OpCode::istore; 
-
-    if (OpCode::istore == op) {
-        code_->instertInstrWithLocal(
-            bb, op, local
-        );
-    } else {
-        code_->insertInstr(bb, op);
-    }
+    code_->instertInstrWithLocal(bb, OpCode::istore, local);
 }
 
 void JVMClassMethod::createLstore(
     bb::BasicBlock* bb, const std::string& local) 
 {
-    auto idx = code_->localIdx(local);
-    auto op = idx == 0 ? OpCode::lstore_0 
-                : idx == 1 ? OpCode::lstore_1 
-                : idx == 2 ? OpCode::lstore_2
-                : idx == 3 ? OpCode::lstore_3
-                : OpCode::lstore; 
-
-    if (OpCode::lstore == op) {
-        code_->instertInstrWithLocal(
-            bb, op, local
-        );
-    } else {
-        code_->insertInstr(bb, op);
-    }
+    code_->instertInstrWithLocal(bb, OpCode::lstore, local);
 }
 
 void JVMClassMethod::createLdc(
     bb::BasicBlock* bb, double numb) 
 {   
     auto cp = selfClass_.lock()->cp();
-    auto [ok, idx] = cp->getNumbConstIdx(numb);
-    if (!ok) {
-        idx = cp->addDouble(numb);
-    }
+    auto idx = cp->addDouble(numb);
     instr::Instr ins(OpCode::ldc2_w);
     ins.pushTwoBytes(idx);
     code_->insertInstr(bb, std::move(ins));
@@ -390,50 +347,39 @@ void JVMClassMethod::createLdc(
     bb::BasicBlock* bb, float numb) 
 {
     auto cp = selfClass_.lock()->cp();
-    auto [ok, idx] = cp->getNumbConstIdx(numb);
-    if (!ok) {
-        idx = cp->addFloat(numb);
-    }
-    std::unique_ptr<instr::Instr> ins;
-    if (idx > std::numeric_limits<std::uint8_t>::max()) {
-        ins.reset(new instr::Instr(OpCode::ldc_w));
-        ins->pushTwoBytes(idx);
+    auto idx = cp->addFloat(numb);
+    bool wide = idx > std::numeric_limits<std::uint8_t>::max();
+    instr::Instr ins(wide ? OpCode::ldc_w : OpCode::ldc);
+    if (wide) {
+        ins.pushTwoBytes(idx);
     } else {
-        ins.reset(new instr::Instr(OpCode::ldc));
-        ins->pushByte(
+        ins.pushByte(
             static_cast<std::uint8_t>(idx));
     }
-    code_->insertInstr(bb, *ins);
+    code_->insertInstr(bb, std::move(ins));
 }   
 
 void JVMClassMethod::createLdc(
     bb::BasicBlock* bb, int numb) 
 {
     auto cp = selfClass_.lock()->cp();
-    auto [ok, idx] = cp->getNumbConstIdx(numb);
-    if (!ok) {
-        idx = cp->addInteger(numb);
-    }
-    std::unique_ptr<instr::Instr> ins;
-    if (idx > std::numeric_limits<std::uint8_t>::max()) {
-        ins.reset(new instr::Instr(OpCode::ldc_w));
-        ins->pushTwoBytes(idx);
+    auto idx = cp->addInteger(numb);
+    bool wide = idx > std::numeric_limits<std::uint8_t>::max();
+    instr::Instr ins(wide ? OpCode::ldc_w : OpCode::ldc);
+    if (wide) {
+        ins.pushTwoBytes(idx);
     } else {
-        ins.reset(new instr::Instr(OpCode::ldc));
-        ins->pushByte(
+        ins.pushByte(
             static_cast<std::uint8_t>(idx));
     }
-    code_->insertInstr(bb, *ins);
+    code_->insertInstr(bb, std::move(ins));
 }   
 
 void JVMClassMethod::createLdc(
     bb::BasicBlock* bb, std::int64_t numb) 
 {
     auto cp = selfClass_.lock()->cp();
-    auto [ok, idx] = cp->getNumbConstIdx(numb);
-    if (!ok) {
-        idx = cp->addLong(numb);
-    }
+    auto idx = cp->addLong(numb);
     instr::Instr ins(OpCode::ldc2_w);
     ins.pushTwoBytes(idx);
     code_->insertInstr(bb, std::move(ins));
@@ -443,20 +389,16 @@ void JVMClassMethod::createLdc(bb::BasicBlock* bb,
     const std::string& string)
 {
     auto cp = selfClass_.lock()->cp();
-    auto [ok, idx] = cp->getStringIdx(string);
-    if (!ok) {
-        idx = cp->addString(string);
-    }
-    std::unique_ptr<instr::Instr> ins;
-    if (idx > std::numeric_limits<std::uint8_t>::max()) {
-        ins.reset(new instr::Instr(OpCode::ldc_w));
-        ins->pushTwoBytes(idx);
+    auto idx = cp->addString(string);
+    bool wide = idx > std::numeric_limits<std::uint8_t>::max();
+    instr::Instr ins(wide ? OpCode::ldc_w : OpCode::ldc);
+    if (wide) {
+        ins.pushTwoBytes(idx);
     } else {
-        ins.reset(new instr::Instr(OpCode::ldc));
-        ins->pushByte(
+        ins.pushByte(
             static_cast<std::uint8_t>(idx));
     }
-    code_->insertInstr(bb, *ins);
+    code_->insertInstr(bb, std::move(ins));
 }   
 
 void JVMClassMethod::createDadd(bb::BasicBlock* bb) {
@@ -648,6 +590,10 @@ void JVMClassMethod::createLreturn(bb::BasicBlock* bb) {
     code_->insertInstr(bb, OpCode::lreturn);    
 }
 
+void JVMClassMethod::createAthrow(bb::BasicBlock* bb) {
+    code_->insertInstr(bb, OpCode::athrow);    
+}
+
 void JVMClassMethod::createIfeq(
     bb::BasicBlock* from, bb::BasicBlock* to) 
 {
@@ -777,6 +723,7 @@ void JVMClassMethod::createMultianewarray(
     auto type = cp->addClass(desc.toString());
     ins.pushTwoBytes(type);
     ins.pushByte(demensions);
+    ins.setStackEffect({demensions, 1});
     code_->insertInstr(bb, std::move(ins));
 }
 
@@ -863,6 +810,8 @@ void JVMClassMethod::createGetfield(
     auto f = selfClass_.lock()->fieldRef(field);
     instr::Instr ins(OpCode::getfield);
     ins.pushTwoBytes(f);
+    auto sz = static_cast<std::uint16_t>(field->fieldType().size());
+    ins.setStackEffect({1, sz});
     code_->insertInstr(bb, std::move(ins));
 }
 
@@ -876,6 +825,8 @@ void JVMClassMethod::createGetstatic(
     auto f = selfClass_.lock()->fieldRef(field);
     instr::Instr ins(OpCode::getstatic);
     ins.pushTwoBytes(f);
+    auto sz = static_cast<std::uint16_t>(field->fieldType().size());
+    ins.setStackEffect({0, sz});
     code_->insertInstr(bb, std::move(ins));
 }
 
@@ -885,6 +836,8 @@ void JVMClassMethod::createPutfield(
     auto f = selfClass_.lock()->fieldRef(field);
     instr::Instr ins(OpCode::putfield);
     ins.pushTwoBytes(f);
+    auto sz = static_cast<std::uint16_t>(field->fieldType().size());
+    ins.setStackEffect({std::uint16_t(1 + sz), 0});
     code_->insertInstr(bb, std::move(ins));
 }
 
@@ -894,6 +847,8 @@ void JVMClassMethod::createPutstatic(
     auto f = selfClass_.lock()->fieldRef(field);
     instr::Instr ins(OpCode::putstatic);
     ins.pushTwoBytes(f);
+    auto sz = static_cast<std::uint16_t>(field->fieldType().size());
+    ins.setStackEffect({sz, 0});
     code_->insertInstr(bb, std::move(ins));
 }
 
@@ -904,6 +859,8 @@ void JVMClassMethod::createInvokespecial(
     auto ref = selfClass_.lock()->methodRef(method);
     instr::Instr ins(OpCode::invokespecial);
     ins.pushTwoBytes(ref);
+    ins.setStackEffect(
+        invokeEffect(method->methodType(), true));
     code_->insertInstr(bb, std::move(ins));
 }
 
@@ -914,6 +871,8 @@ void JVMClassMethod::createInvokevirtual(
     auto ref = selfClass_.lock()->methodRef(method);
     instr::Instr ins(OpCode::invokevirtual);
     ins.pushTwoBytes(ref);
+    ins.setStackEffect(
+        invokeEffect(method->methodType(), true));
     code_->insertInstr(bb, std::move(ins));
 }
 
@@ -929,6 +888,8 @@ void JVMClassMethod::createInvokestatic(
     auto ref = selfClass_.lock()->methodRef(method);
     instr::Instr ins(OpCode::invokestatic);
     ins.pushTwoBytes(ref);
+    ins.setStackEffect(
+        invokeEffect(method->methodType(), false));
     code_->insertInstr(bb, std::move(ins));
 }
 
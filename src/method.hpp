@@ -14,6 +14,12 @@ class JVMClass;
 
 } // namespace jvm_class 
 
+namespace peephole {
+
+class Peephole;
+
+} // namespace peephole
+
 namespace class_member {
 
 class JVMClassMethod : private IJVMClassMember {
@@ -37,12 +43,29 @@ public:
 
 public:
     bb::BasicBlock*createBB();
+    // выполняется до первого bb, созданного через createBB
+    bb::BasicBlock*entryBB();
+    bool hasLocal(const std::string& name) const;
 
     std::uint16_t selfClassRef() const noexcept;
     jvm_class::SharedPtrJVMClass cls();
 
     const std::string& methodName() const noexcept;
     const descriptor::JVMMethodDescriptor& methodType() const noexcept; 
+
+    // на метод уже есть ссылки из кода (через JVMClass::methodRef)
+    bool referenced() const noexcept;
+    void markReferenced() noexcept;
+    // переносит метод без кода в другой класс (см. JVMClass::moveMethod)
+    void moveTo(std::weak_ptr<jvm_class::JVMClass> cls);
+    // тело: вызов target с теми же параметрами и возврат результата
+    void createForwarding(std::shared_ptr<JVMClassMethod> target);
+
+    void setLayoutMode(codegen::LayoutMode mode) noexcept;
+    // вызывается перед finalize, когда код метода готов
+    void optimize(peephole::Peephole& peephole);
+    // вызывается перед printBytes
+    void finalize();
     
 public: 
     // stack
@@ -157,6 +180,7 @@ public:
     void createFreturn(bb::BasicBlock*bb);
     void createIreturn(bb::BasicBlock*bb);
     void createLreturn(bb::BasicBlock*bb);
+    void createAthrow(bb::BasicBlock*bb);
 
     // branch    
     void createIfeq(bb::BasicBlock*from, bb::BasicBlock*to); // == 0
@@ -251,6 +275,7 @@ private:
     std::shared_ptr<jvm_attribute::CodeAttr> code_;
     std::weak_ptr<jvm_class::JVMClass> selfClass_;
     std::uint16_t methodRef_;
+    bool referenced_ = false;
     
     std::string name__;
     descriptor::JVMMethodDescriptor type__;
@@ -1,6 +1,9 @@
 #include "node.hpp"
 
 #include <algorithm>
+#include <bit>
+#include <functional>
+#include <unordered_map>
 
 #include "ada_codegen.hpp"
 
@@ -48,19 +51,6 @@ VarDecl* IExpr::varDecl() noexcept {
 // Stms
 namespace node {
 
-const std::vector<std::string> lvls({
-    "asdfLvl1",
-    "asdfLvl2",
-    "asdfLvl3",
-    "asdfLvl4",
-    "asdfLvl5",
-    "asdfLvl6",
-    "asdfLvl7",
-    "asdfLvl8",
-    "asdfLvl9",
-    "asdfLvl10",
-});
-
 
 Body::Body(const std::vector<std::shared_ptr<IStm>>& stms) :
     stms_(stms)
@@ -137,23 +127,26 @@ IType::descriptor(bool out) {
 void DeclArea::addDecl(std::shared_ptr<IDecl> decl) {
     decls_.push_back(decl);
     decl->setParent(parent_);
+    indexed_ = false;
 }
 
 void DeclArea::removeDecl(std::shared_ptr<IDecl> decl) {
     auto it = std::find(decls_.begin(), decls_.end(), decl);
     if (it != decls_.end()) {
         decls_.erase(it);
+        indexed_ = false;
     }
 }
 
 void DeclArea::replaceDecl(
-    const std::string& name, 
+    const attribute::Symbol& name, 
     std::shared_ptr<IDecl> decl) 
 {
     for (auto&& d : decls_) {
         if (d->name() == name) {
             d.swap(decl);
             d->setParent(this);
+            indexed_ = false;
             return;
         }
     }
@@ -173,6 +166,42 @@ DeclArea::end() {
     return decls_.end();
 }
 
+std::span<const std::shared_ptr<IDecl>> DeclArea::visible(
+    const attribute::Symbol& name, 
+    const IDecl* requester)
+{
+    if (!indexed_.load(std::memory_order_acquire)) {
+        std::lock_guard lock(indexMutex_);
+        if (!indexed_.load(std::memory_order_relaxed)) {
+            buildIndex_();
+        }
+    }
+    auto found = index_.find(name);
+    if (found == index_.end()) {
+        return {};
+    }
+    auto&& [pos, decls] = found->second;
+    auto cnt = decls.size();
+    if (auto req = pos_.find(requester); req != pos_.end()) {
+        cnt = std::upper_bound(pos.begin(), pos.end(), req->second) 
+              - pos.begin();
+    }
+    return {decls.data(), cnt};
+}
+
+void DeclArea::buildIndex_() {
+    index_.clear();
+    pos_.clear();
+    for (std::size_t i = 0; i < decls_.size(); ++i) {
+        auto&& d = decls_[i];
+        auto&& named = index_[d->name()];
+        named.pos.push_back(i);
+        named.decls.push_back(d);
+        pos_.emplace(d.get(), i);
+    }
+    indexed_.store(true, std::memory_order_release);
+}
+
 void DeclArea::setParent(INode* parent) {
     INode::setParent(parent);
     std::for_each(decls_.begin(), decls_.end(), 
@@ -180,7 +209,7 @@ void DeclArea::setParent(INode* parent) {
 }
 
 // VarDecl
-VarDecl::VarDecl(const std::string& name, 
+VarDecl::VarDecl(const attribute::Symbol& name, 
                  std::shared_ptr<IType> type, 
                  std::shared_ptr<IExpr> rval) :
     name_(name)
@@ -197,12 +226,12 @@ VarDecl::VarDecl(const std::string& name,
 void VarDecl::reachable_(
         std::vector<
             std::vector<std::shared_ptr<IDecl>>>& res,
-        std::vector<std::string>::const_iterator it,
-        std::vector<std::string>::const_iterator end,
+        attribute::QualifiedName::const_iterator it,
+        attribute::QualifiedName::const_iterator end,
         IDecl* requester)
 { return; }
 
-const std::string& VarDecl::name() const noexcept {
+const attribute::Symbol& VarDecl::name() const noexcept {
     return name_;
 }
 
@@ -281,77 +310,269 @@ void VarDecl::pregen(
     }
 }
 
+// for (idx = 0; idx < arr.length; ++idx) body;
+// arr, idx - локальные метода, body -> последний bb тела
+static bb::BasicBlock* cgArrayLoop(
+    bb::BasicBlock* bb, 
+    class_member::SharedPtrMethod method,
+    const std::string& arr,
+    const std::string& idx,
+    const std::function<bb::BasicBlock*(bb::BasicBlock*)>& body)
+{
+    method->createIconst(bb, 0);
+    method->createIstore(bb, idx);
+    auto* condBB = method->createBB();
+    auto* bodyBB = method->createBB();
+    method->createGoto(bb, condBB);
+
+    auto* bodyNext = body(bodyBB);
+    method->createIinc(bodyNext, idx, 1);
+    method->createGoto(bodyNext, condBB);
+
+    auto* nextBB = method->createBB();
+    method->createIload(condBB, idx);
+    method->createAload(condBB, arr);
+    method->createArraylength(condBB);
+    method->createIficmplt(condBB, bodyBB);
+    method->createGoto(condBB, nextBB);
+    return nextBB;
+}
+
+// ... -> ... char[]: строка длины из диапазона типа,
+// у неограниченной строки - пустая
+static void cgNewString(
+    bb::BasicBlock* bb, 
+    class_member::SharedPtrMethod method,
+    std::shared_ptr<StringType> str)
+{
+    auto [l, r] = str->range();
+    auto unbound = str->inf() || std::make_pair(-1, -1) == str->range();
+    method->createLdc(bb, unbound ? 0 : r - l + 1);
+    method->createNewarray(bb, codegen::ArrayType::CHAR);
+}
+
+// ... -> ... val: новое значение по умолчанию для элемента массива;
+// false - скаляр, newarray уже заполнил его нулем
+static bool cgNewValue(
+    bb::BasicBlock* bb, 
+    class_member::SharedPtrMethod method,
+    std::shared_ptr<IType> type)
+{
+    type = getOrigin(type);
+    if (auto ref = std::dynamic_pointer_cast<SuperclassReference>(type)) {
+        type = ref->cls()->record();
+    }
+    if (auto rec = std::dynamic_pointer_cast<RecordDecl>(type)) {
+        method->createNew(bb, rec->javaClass());
+        method->createDup(bb);
+        method->createInvokespecial(bb, rec->init());
+        return true;
+    } else if (auto str = std::dynamic_pointer_cast<StringType>(type)) {
+        cgNewString(bb, method, str);
+        return true;
+    }
+    return false;
+}
+
+static descriptor::JVMFieldDescriptor arrayDesc(std::shared_ptr<IType> elem) {
+    auto desc = elem->descriptor();
+    desc.addDimension();
+    return desc;
+}
+
+static codegen::ArrayType newarrayType(SimpleType type) {
+    switch (type) {
+        case SimpleType::BOOL:
+            return codegen::ArrayType::BOOLEAN;
+        case SimpleType::CHAR:
+            return codegen::ArrayType::CHAR;
+        case SimpleType::FLOAT:
+            return codegen::ArrayType::FLOAT;
+        case SimpleType::INTEGER:
+            break;
+    }
+    return codegen::ArrayType::INT;
+}
+
+// ... len -> ... [T: одномерный массив элементов elem
+static void cgNewArray(
+    bb::BasicBlock* bb, 
+    class_member::SharedPtrMethod method,
+    std::shared_ptr<IType> elem)
+{
+    if (auto sTy = std::dynamic_pointer_cast<SimpleLiteralType>(getOrigin(elem))) {
+        method->createNewarray(bb, newarrayType(sTy->type()));
+    } else {
+        method->createMultianewarray(bb, arrayDesc(elem), 1);
+    }
+}
+
+// $init и $copy массивов - статические методы inner_subprograms,
+// по одному на дескриптор: массивы плоские, элемент - не массив
+static std::unordered_map<std::string, class_member::SharedPtrMethod> arrayInits;
+static std::unordered_map<std::string, class_member::SharedPtrMethod> arrayCopies;
+
+static class_member::SharedPtrMethod addArrayHelper(
+    const std::string& name,
+    const descriptor::JVMMethodDescriptor& desc)
+{
+    auto m = codegen::InnerSubprograms->addMethod(name, desc, true);
+    m->addFlag(codegen::java_bytecode_codegen::AccessFlag::ACC_PUBLIC);
+    m->addFlag(codegen::java_bytecode_codegen::AccessFlag::ACC_STATIC);
+    return m;
+}
+
+// $init(arr)V: заполняет элементы массива ссылочного типа;
+// nullptr, если элемент - скаляр
+static class_member::SharedPtrMethod arrayInit(std::shared_ptr<IType> elem) {
+    if (std::dynamic_pointer_cast<SimpleLiteralType>(getOrigin(elem))) {
+        return nullptr;
+    }
+    auto desc = arrayDesc(elem);
+    if (auto it = arrayInits.find(desc.toString()); it != arrayInits.end()) {
+        return it->second;
+    }
+
+    auto m = addArrayHelper("$init",
+        descriptor::JVMMethodDescriptor::createVoidRetun({{"arr", desc}}));
+    m->createLocalInt("i");
+    auto* bb = m->createBB();
+    bb = cgArrayLoop(bb, m, "arr", "i", [&] (bb::BasicBlock* body) {
+        m->createAload(body, "arr");
+        m->createIload(body, "i");
+        cgNewValue(body, m, elem);
+        m->createAastore(body);
+        return body;
+    });
+    m->createReturn(bb);
+
+    arrayInits.emplace(desc.toString(), m);
+    return m;
+}
+
+static class_member::SharedPtrMethod arrayCopy(std::shared_ptr<IType> elem);
+
+// ... val -> ... copy: глубокая копия значения типа type
+static bb::BasicBlock* cgCopy(
+    bb::BasicBlock* bb, 
+    class_member::SharedPtrMethod method,
+    std::shared_ptr<IType> type)
+{
+    type = getOrigin(type);
+    if (auto ref = std::dynamic_pointer_cast<SuperclassReference>(type)) {
+        // ссылка на базовый класс может быть не задана
+        auto rec = ref->cls()->record();
+        auto* copyBB = method->createBB();
+        auto* nextBB = method->createBB();
+        method->createDup(bb);
+        method->createIfnull(bb, nextBB);
+        method->createGoto(bb, copyBB);
+        method->createInvokevirtual(copyBB, rec->copy());
+        method->createCheckcast(copyBB, rec->javaClass());
+        method->createGoto(copyBB, nextBB);
+        return nextBB;
+    } else if (auto rec = std::dynamic_pointer_cast<RecordDecl>(type)) {
+        method->createInvokevirtual(bb, rec->copy());
+        method->createCheckcast(bb, rec->javaClass());
+    } else if (auto arr = std::dynamic_pointer_cast<ArrayType>(type)) {
+        method->createInvokestatic(bb, arrayCopy(arr->type()));
+    } else if (std::dynamic_pointer_cast<StringType>(type)) {
+        static auto CHAR_TY = std::make_shared<SimpleLiteralType>(SimpleType::CHAR);
+        method->createInvokestatic(bb, arrayCopy(CHAR_TY));
+    }
+    return bb;
+}
+
+// $copy(src)[T: массив скаляров - System.arraycopy,
+// иначе поэлементно через $copy элементов
+static class_member::SharedPtrMethod arrayCopy(std::shared_ptr<IType> elem) {
+    auto desc = arrayDesc(elem);
+    if (auto it = arrayCopies.find(desc.toString()); it != arrayCopies.end()) {
+        return it->second;
+    }
+
+    auto m = addArrayHelper("$copy",
+        descriptor::JVMMethodDescriptor::create({{"src", desc}}, desc));
+    m->createLocalRef("dst");
+    auto* bb = m->createBB();
+    m->createAload(bb, "src");
+    m->createArraylength(bb);
+    cgNewArray(bb, m, elem);
+    m->createAstore(bb, "dst");
+
+    if (std::dynamic_pointer_cast<SimpleLiteralType>(getOrigin(elem))) {
+        m->createAload(bb, "src");
+        m->createIconst(bb, 0);
+        m->createAload(bb, "dst");
+        m->createIconst(bb, 0);
+        m->createAload(bb, "src");
+        m->createArraylength(bb);
+        m->createInvokestatic(bb, codegen::JavaSystemArraycopy);
+    } else {
+        m->createLocalInt("i");
+        bb = cgArrayLoop(bb, m, "src", "i", [&] (bb::BasicBlock* body) {
+            m->createAload(body, "dst");
+            m->createIload(body, "i");
+            m->createAload(body, "src");
+            m->createIload(body, "i");
+            m->createAaload(body);
+            body = cgCopy(body, m, elem);
+            m->createAastore(body);
+            return body;
+        });
+    }
+    m->createAload(bb, "dst");
+    m->createAreturn(bb);
+
+    arrayCopies.emplace(desc.toString(), m);
+    return m;
+}
+
 static void cgCreateArray(
     bb::BasicBlock* bb, 
     class_member::SharedPtrMethod method, 
     std::shared_ptr<ArrayType> arr)
 {
-
-    for (auto [l, r] : arr->ranges()) {
-        method->createLdc(bb, r - l + 1);
+    method->createLdc(bb, arr->length());
+    cgNewArray(bb, method, arr->type());
+    if (auto init = arrayInit(arr->type())) {
+        method->createDup(bb);
+        method->createInvokestatic(bb, init);
     }
-    auto arrDesc = arr->descriptor();
-    auto dem = static_cast<std::uint8_t>(arr->ranges().size());
-    method->createMultianewarray(bb, arrDesc, dem);
-    method->createDup(bb);
-    method->createInvokestatic(bb, codegen::AdaUtilityInitArrayElements);
 }
 
+// значения агрегата лежат на стеке, первый сверху;
+// плоский массив заполняется ими подряд
 void createLoadAggr(
     std::shared_ptr<VarDecl> arr, 
     bb::BasicBlock* bb, 
-    class_member::SharedPtrMethod method,
-    int lvl = 0) 
+    class_member::SharedPtrMethod method) 
 {
     auto arrTy = std::dynamic_pointer_cast<ArrayType>(arr->type());
     assert(arrTy);
+    auto sTy = std::dynamic_pointer_cast<SimpleLiteralType>(arrTy->type());
+    assert(sTy);
 
-    // получить конкретный массив
-    auto [l, r] = arrTy->ranges()[lvl];
-    int lim = r - l + 1;
-    if (lvl < arrTy->ranges().size() - 1) {
-        for (int i = 0; i < lim; ++i) {
-            if (0 == lvl) {
-                 arr->createLoad(bb, method);
-            } else {
-                method->createAload(bb, lvls[lvl - 1]);
-            }
-            
-            method->createLdc(bb, i);
-            method->createAaload(bb);
-
-            method->createAstore(bb, lvls[lvl]);
-            createLoadAggr(arr, bb, method, lvl + 1);
-        }
-    // загрузить агрегат в массив
-    } else {
-        for (int i = 0; i < lim; ++i) {
-            if (0 == lvl) {
-                 arr->createLoad(bb, method);
-            } else {
-                method->createAload(bb, lvls[lvl - 1]);
-            }
-            method->createLdc(bb, i);
-            method->createDup2X1(bb);
-            method->createPop(bb);
-            method->createPop(bb);
-            auto sTy = std::dynamic_pointer_cast<SimpleLiteralType>(arrTy->type());
-            assert(sTy);
-            switch (sTy->type()) {
-                case SimpleType::BOOL:
-                    method->createBastore(bb);
-                    break;
-                case SimpleType::CHAR:
-                    method->createCastore(bb);
-                    break;
-                case SimpleType::FLOAT:
-                    method->createFastore(bb);
-                    break;
-                case SimpleType::INTEGER:
-                    method->createIastore(bb);
-                    break;
-            } 
-        }
+    for (int i = 0; i < arrTy->length(); ++i) {
+        arr->createLoad(bb, method);
+        method->createLdc(bb, i);
+        method->createDup2X1(bb);
+        method->createPop(bb);
+        method->createPop(bb);
+        switch (sTy->type()) {
+            case SimpleType::BOOL:
+                method->createBastore(bb);
+                break;
+            case SimpleType::CHAR:
+                method->createCastore(bb);
+                break;
+            case SimpleType::FLOAT:
+                method->createFastore(bb);
+                break;
+            case SimpleType::INTEGER:
+                method->createIastore(bb);
+                break;
+        } 
     }
 }
 
@@ -366,28 +587,21 @@ void VarDecl::codegen(
     // если есть инициализация
     if (rval_) {
         bb = rval_->codegen(bb, method);
+        auto aggr = arr && 
+            std::dynamic_pointer_cast<AggregateType>(rval_->type());
+        // owned значение забирается без копии
+        if ((rec || arr || str) && !aggr && !rval_->owned()) {
+            bb = cgCopy(bb, method, type_);
+        }
         nextBB_ = bb;
         if (method->methodName() == "<init>") {
             method->createAload(bb, "this");
         }
-        if (rec) {
-            method->createInvokestatic(bb, codegen::AdaUtilityDeepCopy);
-            method->createCheckcast(bb, rec->javaClass());
-            createStore(bb, method);
-        } else if (arr) {
-            if (auto arrTy = std::dynamic_pointer_cast<node::ArrayType>(rval_->type())) {
-                // дублирование массива
-                method->createInvokestatic(bb, codegen::AdaUtilityDeepCopyArray);
-                createStore(bb, method);
-            } else if (auto aggrTy = std::dynamic_pointer_cast<AggregateType>(rval_->type())) {
-                // работа с агрегатом
-                cgCreateArray(bb, method, arr);
-                createStore(bb, method);
-                createLoadAggr(std::dynamic_pointer_cast<VarDecl>(self()), bb, method);
-            } 
-        } else if (str) {
-            method->createInvokestatic(bb, codegen::AdaUtilityCopyStringBuilder);
+        if (aggr) {
+            // работа с агрегатом
+            cgCreateArray(bb, method, arr);
             createStore(bb, method);
+            createLoadAggr(std::dynamic_pointer_cast<VarDecl>(self()), bb, method);
         } else {
             createStore(bb, method);
         }
@@ -402,14 +616,68 @@ void VarDecl::codegen(
             cgCreateArray(bb, method, arr);
             createStore(bb, method);
         } else if (str) {
-            method->createNew(bb, codegen::StringBuiler);
-            method->createDup(bb);
-            method->createInvokespecial(bb, codegen::AdaUtilityStringBuilderInit);
+            cgNewString(bb, method, str);
             createStore(bb, method);
         }
     }
 }
 
+// holder: массив из одного элемента
+static void cgHolderLoad(
+    bb::BasicBlock* bb, 
+    class_member::SharedPtrMethod method, 
+    SimpleType type)
+{
+    // ... holder -> ... val
+    method->createIconst(bb, 0);
+    switch (type) {
+        case SimpleType::BOOL:
+            method->createBaload(bb);
+            break;
+        case SimpleType::CHAR:
+            method->createCaload(bb);
+            break;
+        case SimpleType::FLOAT:
+            method->createFaload(bb);
+            break;
+        case SimpleType::INTEGER:
+            method->createIaload(bb);
+            break;
+    }
+}
+
+static void cgHolderStore(
+    bb::BasicBlock* bb, 
+    class_member::SharedPtrMethod method, 
+    SimpleType type)
+{
+    // ... holder, idx, val -> ...
+    switch (type) {
+        case SimpleType::BOOL:
+            method->createBastore(bb);
+            break;
+        case SimpleType::CHAR:
+            method->createCastore(bb);
+            break;
+        case SimpleType::FLOAT:
+            method->createFastore(bb);
+            break;
+        case SimpleType::INTEGER:
+            method->createIastore(bb);
+            break;
+    }
+}
+
+bool VarDecl::holder() noexcept {
+    if (!(param_ && out_) || 
+        !std::dynamic_pointer_cast<SimpleLiteralType>(type())) 
+    {
+        return false;
+    }
+    auto proc = dynamic_cast<ProcBody*>(parent());
+    return !(proc && proc->outResult().get() == this);
+}
+
 void VarDecl::createLoad(
     bb::BasicBlock* bb, 
     class_member::SharedPtrMethod method)
@@ -418,9 +686,13 @@ void VarDecl::createLoad(
         method->createGetstatic(bb, javaField_);
     } else if (javaField_) {
         method->createGetfield(bb, javaField_);
+    } else if (holder()) {
+        auto sTy = std::dynamic_pointer_cast<SimpleLiteralType>(type());
+        method->createAload(bb, name_);
+        cgHolderLoad(bb, method, sTy->type());
     } else {
         auto sTy = std::dynamic_pointer_cast<SimpleLiteralType>(type_);
-        if (sTy && !(param_ && out_)) {
+        if (sTy) {
             switch (sTy->type()) {
                 case SimpleType::BOOL: case SimpleType::CHAR: case SimpleType::INTEGER:
                     method->createIload(bb, name_);
@@ -444,9 +716,17 @@ void VarDecl::createStore(
     } else if (javaField_) {
         method->createSwap(bb);
         method->createPutfield(bb, javaField_);
+    } else if (holder()) {
+        // ... val -> ... holder, 0, val
+        auto sTy = std::dynamic_pointer_cast<SimpleLiteralType>(type());
+        method->createAload(bb, name_);
+        method->createSwap(bb);
+        method->createIconst(bb, 0);
+        method->createSwap(bb);
+        cgHolderStore(bb, method, sTy->type());
     } else {
         auto sTy = std::dynamic_pointer_cast<SimpleLiteralType>(type_);
-        if (sTy && !(param_ && out_)) {
+        if (sTy) {
             switch (sTy->type()) {
                 case SimpleType::BOOL: case SimpleType::CHAR: case SimpleType::INTEGER:
                     method->createIstore(bb, name_);
@@ -461,86 +741,8 @@ void VarDecl::createStore(
     }
 }
 
-// codegen
-const std::vector<std::string> atomicRefs({
-    "AtomicRef1",
-    "AtomicRef2",
-    "AtomicRef3",
-    "AtomicRef4",
-    "AtomicRef5",
-    "AtomicRef6",
-    "AtomicRef7",
-    "AtomicRef8",
-    "AtomicRef9",
-    "AtomicRef10",
-});
-
-int curRef = 0;
-int curRefForLoad = 0;
-
-void VarDecl::createRef(bb::BasicBlock* bb, 
-                class_member::SharedPtrMethod method)
-{
-    auto sTy = std::dynamic_pointer_cast<SimpleLiteralType>(type_);
-    assert(sTy);
-
-    auto&& ref = atomicRefs[curRef++];
-    curRefForLoad = 0;
-
-    assert(curRef >= 0);
-    if (curRef >= atomicRefs.size()) {
-        throw std::runtime_error("ref params > 10");
-    }
-
-    createLoad(bb, method);
-    switch (sTy->type()) {
-        case SimpleType::BOOL:
-            method->createInvokestatic(bb, codegen::AdaUtilityToAtomicBoolean);
-            break;
-        case SimpleType::CHAR:
-            method->createInvokestatic(bb, codegen::AdaUtilityToAtomicChar);
-            break;
-        case SimpleType::FLOAT:
-            method->createInvokestatic(bb, codegen::AdaUtilityToAtomicFloat);
-            break;
-        case SimpleType::INTEGER:
-            method->createInvokestatic(bb, codegen::AdaUtilityToAtomicInt);
-            break;
-    }
-    method->createDup(bb);
-    method->createAstore(bb, ref);
-}
-
-void VarDecl::loadFromRef(bb::BasicBlock* bb,
-                    class_member::SharedPtrMethod method)
-{
-    auto sTy = std::dynamic_pointer_cast<SimpleLiteralType>(type_);
-    assert(sTy);
-
-    auto&& ref = atomicRefs[curRefForLoad++];
-    curRef = 0;
-
-    method->createAload(bb, ref);
-    switch (sTy->type()) {
-        case SimpleType::BOOL:
-            method->createInvokestatic(bb, codegen::AdaUtilityFromAtomicBoolean);
-            break;
-        case SimpleType::CHAR:
-            method->createInvokestatic(bb, codegen::AdaUtilityFromAtomicChar);
-            break;
-        case SimpleType::FLOAT:
-            method->createInvokestatic(bb, codegen::AdaUtilityFromAtomicFloat);
-            break;
-        case SimpleType::INTEGER:
-            method->createInvokestatic(bb, codegen::AdaUtilityFromAtomicInt);
-            break;
-    }  
-
-    createStore(bb, method);
-}
-
 // ProcBody
-ProcBody::ProcBody(const std::string& name, 
+ProcBody::ProcBody(const attribute::Symbol& name, 
                    const std::vector<std::shared_ptr<VarDecl>>& params,
                    std::shared_ptr<DeclArea> decls,
                    std::shared_ptr<Body> body) :
@@ -558,9 +760,10 @@ ProcBody::ProcBody(const std::string& name,
     body_->setParent(this);
 }
 
-const std::string& ProcBody::name() const noexcept {
-    static const std::string get = "get";
-    return name_ == "getc" ? get : name_;
+const attribute::Symbol& ProcBody::name() const noexcept {
+    static const attribute::Symbol get("get");
+    static const attribute::Symbol getc("getc");
+    return name_ == getc ? get : name_;
 }
 
 std::shared_ptr<DeclArea> ProcBody::decls() {
@@ -579,8 +782,8 @@ std::shared_ptr<node::Body> ProcBody::body() {
 void ProcBody::reachable_(
         std::vector<
             std::vector<std::shared_ptr<IDecl>>>& res,
-        std::vector<std::string>::const_iterator it,
-        std::vector<std::string>::const_iterator end,
+        attribute::QualifiedName::const_iterator it,
+        attribute::QualifiedName::const_iterator end,
         IDecl* requester) 
 {
     if (it == end) return;
@@ -598,22 +801,17 @@ void ProcBody::reachable_(
         }
     }
 
-    for (auto decl : *decls_) {
-        if (decl->name() == *it) {
-            if (std::distance(it, end) == 1) {
-                if (!insert) {
-                    res.emplace_back();
-                    insert = true;
-                }
-                res.back().push_back(decl);
-            } else if (!std::dynamic_pointer_cast<ProcBody>(decl)) {
-                decl->reachable_(
-                    res, std::next(it), end, requester);
-            }   
-        }
-        if (decl.get() == requester) {
-            break;
-        }
+    for (auto&& decl : decls_->visible(*it, requester)) {
+        if (std::distance(it, end) == 1) {
+            if (!insert) {
+                res.emplace_back();
+                insert = true;
+            }
+            res.back().push_back(decl);
+        } else if (!std::dynamic_pointer_cast<ProcBody>(decl)) {
+            decl->reachable_(
+                res, std::next(it), end, requester);
+        }   
     }
 }
 
@@ -653,9 +851,17 @@ descriptor::JVMMethodDescriptor ProcBody::desc() {
     for (; it != params_.end(); ++it) {
         auto var = *it;
         paramsDescr.emplace_back(
-            var->name(), var->type()->descriptor(var->out() && var->param()));
+            var->name(), var->type()->descriptor(var->holder()));
     } 
 
+    if (auto res = outResult()) {
+        auto retDesc = res->type()->descriptor();
+        if (paramsDescr.empty()) {
+            return JVMMethodDescriptor::createVoidParams(retDesc);
+        }
+        return JVMMethodDescriptor::create(paramsDescr, retDesc);
+    }
+
     if (paramsDescr.empty()) {
         return JVMMethodDescriptor::createVoidParamsVoidReturn();
     } else {
@@ -663,6 +869,44 @@ descriptor::JVMMethodDescriptor ProcBody::desc() {
     }
 }
 
+std::shared_ptr<VarDecl> ProcBody::outResult() const {
+    if (javaMain_ || dynamic_cast<const FuncBody*>(this)) {
+        return nullptr;
+    }
+    std::shared_ptr<VarDecl> res;
+    for (auto&& p : params_) {
+        if (!(p->param() && p->out() && 
+              std::dynamic_pointer_cast<SimpleLiteralType>(p->type()))) 
+        { continue; }
+        if (res) {
+            return nullptr;
+        }
+        res = p;
+    }
+    return res;
+}
+
+void ProcBody::createReturn(
+    bb::BasicBlock* bb, 
+    class_member::SharedPtrMethod method) 
+{
+    auto res = outResult();
+    if (!res) {
+        method->createReturn(bb);
+        return;
+    }
+    res->createLoad(bb, method);
+    auto sTy = std::dynamic_pointer_cast<SimpleLiteralType>(res->type());
+    switch (sTy->type()) {
+        case SimpleType::BOOL: case SimpleType::CHAR: case SimpleType::INTEGER:
+            method->createIreturn(bb);
+            break;
+        case SimpleType::FLOAT:
+            method->createFreturn(bb);
+            break;
+    }
+}
+
 void ProcBody::pregen(
     jvm_class::SharedPtrJVMClass cls, 
     class_member::SharedPtrMethod method,
@@ -702,14 +946,6 @@ void ProcBody::pregen(
         }
     }
 
-    for (auto&& r : atomicRefs) {
-        javaMethod_->createLocalRef(r);
-    }
-
-    for (auto&& l : lvls) {
-        javaMethod_->createLocalRef(l);
-    }
-
     javaMethod_->addFlag(
         codegen::java_bytecode_codegen::AccessFlag::ACC_PUBLIC);
     
@@ -725,12 +961,13 @@ void ProcBody::codegen(
     if (dynamic_cast<node::ProcDecl*>(this) || 
         dynamic_cast<node::FuncDecl*>(this)) 
     { return; }
+    codegen::cg.ensureConstPoolRoom(javaMethod_);
     for (auto&& d : *decls_) {
         d->codegen(javaMethod_->createBB(), javaMethod_);
     }
     auto* _ = body_->codegen(javaMethod_, javaMethod_->createBB());
     if (!dynamic_cast<FuncBody*>(this)) {
-        javaMethod_->createReturn(javaMethod_->createBB());
+        createReturn(javaMethod_->createBB(), javaMethod_);
     }
 }
 
@@ -742,7 +979,7 @@ void ProcBody::printClass()  {
 
 
 // ProcDecl
-ProcDecl::ProcDecl(const std::string& name, 
+ProcDecl::ProcDecl(const attribute::Symbol& name, 
                    const std::vector<std::shared_ptr<VarDecl>>& params) :
     ProcBody(name, params, 
              std::make_shared<DeclArea>(), 
@@ -763,7 +1000,7 @@ void ProcDecl::createCall(
 
 
 // FuncBody
-FuncBody::FuncBody(const std::string& name, 
+FuncBody::FuncBody(const attribute::Symbol& name, 
                    const std::vector<std::shared_ptr<VarDecl>>& params,
                    std::shared_ptr<DeclArea> decls,
                    std::shared_ptr<Body> body,
@@ -794,7 +1031,7 @@ descriptor::JVMMethodDescriptor FuncBody::desc() {
     for (; it != params_.end(); ++it) {
         auto var = *it;
         paramsDescr.emplace_back(
-            var->name(), var->type()->descriptor(var->out() && var->param()));
+            var->name(), var->type()->descriptor(var->holder()));
     } 
 
     auto retDesc = retType_->descriptor();
@@ -806,7 +1043,7 @@ descriptor::JVMMethodDescriptor FuncBody::desc() {
 }
 
 // FuncDecl 
-FuncDecl::FuncDecl(const std::string& name, 
+FuncDecl::FuncDecl(const attribute::Symbol& name, 
                    const std::vector<std::shared_ptr<VarDecl>>& params,
                    std::shared_ptr<IType> retType) :
     FuncBody(name, params, 
@@ -829,7 +1066,7 @@ void FuncDecl::createCall(
 }
 
 // PackDecl
-PackDecl::PackDecl(const std::string& name, 
+PackDecl::PackDecl(const attribute::Symbol& name, 
                    std::shared_ptr<DeclArea> decls,
                    std::shared_ptr<DeclArea> privateDecls):
     name_(name)
@@ -845,47 +1082,42 @@ PackDecl::PackDecl(const std::string& name,
     }
 }
 
-const std::string& PackDecl::name() const noexcept {
+const attribute::Symbol& PackDecl::name() const noexcept {
     return name_;
 }
 
 void PackDecl::reachable_(
         std::vector<
             std::vector<std::shared_ptr<IDecl>>>& res,
-        std::vector<std::string>::const_iterator it,
-        std::vector<std::string>::const_iterator end,
+        attribute::QualifiedName::const_iterator it,
+        attribute::QualifiedName::const_iterator end,
         IDecl* requester) 
 {
     if (it == end) return;
 
     bool insert = false;
-    for (auto decl : *decls_) {
-        if (decl->name() == *it /* || (requester && requester->parent() == this && *it == name_) */) {
-            if (requester && requester->parent() == this && *it == name_) {
-                ++it;
-            }
-            if (std::distance(it, end) == 1) {
-                if (!insert) {
-                    res.emplace_back();
-                    insert = true;
-                }
-                res.back().push_back(decl);
-            } else if (!std::dynamic_pointer_cast<ProcBody>(decl)) {
-                decl->reachable_(
-                    res, std::next(it), end, requester);
-            }   
-        }
-        if (decl.get() == requester) {
-            break;
+    for (auto&& decl : decls_->visible(*it, requester)) {
+        if (requester && requester->parent() == this && *it == name_) {
+            ++it;
         }
+        if (std::distance(it, end) == 1) {
+            if (!insert) {
+                res.emplace_back();
+                insert = true;
+            }
+            res.back().push_back(decl);
+        } else if (!std::dynamic_pointer_cast<ProcBody>(decl)) {
+            decl->reachable_(
+                res, std::next(it), end, requester);
+        }   
     }
 }
 
 void PackDecl::reachableForPackBody_(
     std::vector<
         std::vector<std::shared_ptr<IDecl>>>& res,
-    std::vector<std::string>::const_iterator it,
-    std::vector<std::string>::const_iterator end,
+    attribute::QualifiedName::const_iterator it,
+    attribute::QualifiedName::const_iterator end,
     IDecl* requester) 
 {
     if (it == end) return;
@@ -897,22 +1129,17 @@ void PackDecl::reachableForPackBody_(
     }
     
     bool insert = false;
-    for (auto decl : *privateDecls_) {
-        if (decl->name() == *it) {
-            if (std::distance(it, end) == 1) {
-                if (!insert) {
-                    res.emplace_back();
-                    insert = true;
-                }
-                res.back().push_back(decl);
-            } else if (!std::dynamic_pointer_cast<ProcBody>(decl)) {
-                decl->reachable_(
-                    res, std::next(it), end, requester);
-            }   
-        }
-        if (decl.get() == requester) {
-            break;
-        }
+    for (auto&& decl : privateDecls_->visible(*it, requester)) {
+        if (std::distance(it, end) == 1) {
+            if (!insert) {
+                res.emplace_back();
+                insert = true;
+            }
+            res.back().push_back(decl);
+        } else if (!std::dynamic_pointer_cast<ProcBody>(decl)) {
+            decl->reachable_(
+                res, std::next(it), end, requester);
+        }   
     }
 }
 
@@ -996,7 +1223,7 @@ void PackDecl::printClass() {
 }
 
 // PackBody
-PackBody::PackBody(const std::string& name, 
+PackBody::PackBody(const attribute::Symbol& name, 
                    std::shared_ptr<DeclArea> decls) :
     PackDecl(name, decls)
 {}
@@ -1017,8 +1244,8 @@ PackBody::reachable(
 void PackBody::reachable_(
     std::vector<
         std::vector<std::shared_ptr<IDecl>>>& res,
-    std::vector<std::string>::const_iterator it,
-    std::vector<std::string>::const_iterator end,
+    attribute::QualifiedName::const_iterator it,
+    attribute::QualifiedName::const_iterator end,
     IDecl* requester) 
 {
     if (!requester || requester->parent() != this) {
@@ -1028,22 +1255,17 @@ void PackBody::reachable_(
         ++it;
     }
     bool insert = false;
-    for (auto decl : *decls_) {
-        if (decl->name() == *it) {
-            if (std::distance(it, end) == 1) {
-                if (!insert) {
-                    res.emplace_back();
-                    insert = true;
-                }
-                res.back().push_back(decl);
-            } else if (!std::dynamic_pointer_cast<ProcBody>(decl)) {
-                decl->reachable_(
-                    res, std::next(it), end, requester);
-            }   
-        }
-        if (decl.get() == requester) {
-            break;
-        }
+    for (auto&& decl : decls_->visible(*it, requester)) {
+        if (std::distance(it, end) == 1) {
+            if (!insert) {
+                res.emplace_back();
+                insert = true;
+            }
+            res.back().push_back(decl);
+        } else if (!std::dynamic_pointer_cast<ProcBody>(decl)) {
+            decl->reachable_(
+                res, std::next(it), end, requester);
+        }   
     }
     auto pack = packDecl_.lock();
     assert(pack && "no pack decl for pack body");
@@ -1062,8 +1284,8 @@ GlobalSpace::GlobalSpace(std::shared_ptr<IDecl> unit) :
 void GlobalSpace::reachable_(
     std::vector<
         std::vector<std::shared_ptr<IDecl>>>& res,
-    std::vector<std::string>::const_iterator it,
-    std::vector<std::string>::const_iterator end,
+    attribute::QualifiedName::const_iterator it,
+    attribute::QualifiedName::const_iterator end,
     IDecl* requester) 
 {
     if (it == end) return;
@@ -1103,8 +1325,8 @@ const std::vector<std::shared_ptr<IDecl>>&
 GlobalSpace::imports() const noexcept
 { return imports_; }
 
-const std::string& GlobalSpace::name() const noexcept {
-    static const std::string name__ = "global";
+const attribute::Symbol& GlobalSpace::name() const noexcept {
+    static const attribute::Symbol name__("global");
     return name__; 
 }
 
@@ -1134,7 +1356,7 @@ With::name() const noexcept {
 }
 
 // RecordDecl
-RecordDecl::RecordDecl(const std::string& name, 
+RecordDecl::RecordDecl(const attribute::Symbol& name, 
                        std::shared_ptr<DeclArea> decls, 
                        attribute::QualifiedName base, 
                        bool isTagged) :
@@ -1147,7 +1369,7 @@ RecordDecl::RecordDecl(const std::string& name,
     decls_->setParent(this);
 }
 
-const std::string& RecordDecl::name() const noexcept {
+const attribute::Symbol& RecordDecl::name() const noexcept {
     return name_;
 }
 
@@ -1200,27 +1422,22 @@ void RecordDecl::setClass(std::shared_ptr<ClassDecl> cls) {
 void RecordDecl::reachable_(
     std::vector<
         std::vector<std::shared_ptr<IDecl>>>& res,
-    std::vector<std::string>::const_iterator it,
-    std::vector<std::string>::const_iterator end,
+    attribute::QualifiedName::const_iterator it,
+    attribute::QualifiedName::const_iterator end,
     IDecl* requester)
 {   
     bool insert = false;
-    for (auto decl : *decls_) {
-        if (decl->name() == *it) {
-            if (std::distance(it, end) == 1) {
-                if (!insert) {
-                    res.emplace_back();
-                    insert = true;
-                }
-                res.back().push_back(decl);
-            } else if (!std::dynamic_pointer_cast<ProcBody>(decl)) {
-                decl->reachable_(
-                    res, std::next(it), end, requester);
-            }   
-        }
-        if (decl.get() == requester) {
-            break;
-        }
+    for (auto&& decl : decls_->visible(*it, requester)) {
+        if (std::distance(it, end) == 1) {
+            if (!insert) {
+                res.emplace_back();
+                insert = true;
+            }
+            res.back().push_back(decl);
+        } else if (!std::dynamic_pointer_cast<ProcBody>(decl)) {
+            decl->reachable_(
+                res, std::next(it), end, requester);
+        }   
     }
     if (auto base = baseRecord_.lock()) {
         base->reachable_(res, it, end, requester);
@@ -1243,9 +1460,17 @@ void RecordDecl::pregen(
     auto initDesc = 
         descriptor::JVMMethodDescriptor::createVoidParamsVoidReturn();
     init_ = javaClass_->addMethod("<init>", initDesc);
+    copyInit_ = javaClass_->addMethod("<init>", 
+        descriptor::JVMMethodDescriptor::createVoidRetun({{"src", descriptor()}}));
+    // у всех записей один дескриптор: $copy производной перекрывает базовый
+    copy_ = javaClass_->addMethod("$copy", 
+        descriptor::JVMMethodDescriptor::createVoidParams(
+            descriptor::JVMFieldDescriptor::createObject(
+                codegen::JavaObject->name())));
+    copy_->addFlag(codegen::java_bytecode_codegen::AccessFlag::ACC_PUBLIC);
     for (auto&& d : deriveRecords_) {
         d->setJavaClassParrent(javaClass_);
-        d->setParentInit(init_);
+        d->setParentInit(init_, copyInit_);
     }
 
     if (auto cls = class_.lock()) {
@@ -1288,6 +1513,33 @@ void RecordDecl::codegen(
         initBB = v->nextBB();
     }
     init_->createReturn(initBB);
+
+    // <init>(src): поля базовой записи копирует ее конструктор,
+    // свои - напрямую, без рефлексии
+    auto* copyBB = copyInit_->createBB();
+    copyInit_->createAload(copyBB, "this");
+    if (baseCopyInit_) {
+        copyInit_->createAload(copyBB, "src");
+        copyInit_->createInvokespecial(copyBB, baseCopyInit_);
+    } else {
+        copyInit_->createInvokespecial(copyBB, codegen::AdaUtilityJavaObjectInit);
+    }
+    for (auto&& var : *decls_) {
+        auto v = std::dynamic_pointer_cast<VarDecl>(var);
+        copyInit_->createAload(copyBB, "src");
+        v->createLoad(copyBB, copyInit_);
+        copyBB = cgCopy(copyBB, copyInit_, v->type());
+        copyInit_->createAload(copyBB, "this");
+        v->createStore(copyBB, copyInit_);
+    }
+    copyInit_->createReturn(copyBB);
+
+    auto* cBB = copy_->createBB();
+    copy_->createNew(cBB, javaClass_);
+    copy_->createDup(cBB);
+    copy_->createAload(cBB, "this");
+    copy_->createInvokespecial(cBB, copyInit_);
+    copy_->createAreturn(cBB);
 }
 
 void RecordDecl::printClass() {
@@ -1309,7 +1561,7 @@ void RecordDecl::createJavaClass_() {
 }
 
 //TypeAliasDecl
-TypeAliasDecl::TypeAliasDecl(const std::string& name, 
+TypeAliasDecl::TypeAliasDecl(const attribute::Symbol& name, 
                             std::shared_ptr<IType> origin):
     name_(name)
     , origin_(origin)
@@ -1318,7 +1570,7 @@ TypeAliasDecl::TypeAliasDecl(const std::string& name,
 }
 
 
-const std::string& TypeAliasDecl::name() const noexcept {
+const attribute::Symbol& TypeAliasDecl::name() const noexcept {
     return name_;
 }
 
@@ -1346,8 +1598,8 @@ void TypeAliasDecl::resetOrigin(
 void TypeAliasDecl::reachable_(
     std::vector<
         std::vector<std::shared_ptr<IDecl>>>& res,
-    std::vector<std::string>::const_iterator it,
-    std::vector<std::string>::const_iterator end,
+    attribute::QualifiedName::const_iterator it,
+    attribute::QualifiedName::const_iterator end,
     IDecl* requester) 
 { return; }
 
@@ -1378,31 +1630,25 @@ descriptor::JVMFieldDescriptor
 SimpleLiteralType::descriptor(bool out) {
     using namespace codegen;
     using namespace descriptor;
-    if (!out) {
-        switch (type_) {
-            case SimpleType::BOOL: 
-                return JVMFieldDescriptor::createFundamental(FundamentalType::BOOLEAN);
-            case SimpleType::INTEGER: 
-                return JVMFieldDescriptor::createFundamental(FundamentalType::INT);
-            case SimpleType::FLOAT: 
-                return JVMFieldDescriptor::createFundamental(FundamentalType::FLOAT);
-            case SimpleType::CHAR: 
-                return JVMFieldDescriptor::createFundamental(FundamentalType::CHAR);
-        }
-    } else {
-        switch (type_) {
-            case SimpleType::BOOL: 
-                return JVMFieldDescriptor::createObject({"java", "util", "concurrent", "atomic", "AtomicBoolean"});
-            case SimpleType::INTEGER: 
-                return JVMFieldDescriptor::createObject({"java", "util", "concurrent", "atomic", "AtomicInteger"});
-            case SimpleType::FLOAT: 
-                return JVMFieldDescriptor::createObject({"java", "util", "concurrent", "atomic", "AtomicReference"}); 
-            case SimpleType::CHAR: 
-                return JVMFieldDescriptor::createObject({"java", "util", "concurrent", "atomic", "AtomicInteger"}); 
-        }
+    auto desc = JVMFieldDescriptor::createFundamental(FundamentalType::INT);
+    switch (type_) {
+        case SimpleType::BOOL: 
+            desc = JVMFieldDescriptor::createFundamental(FundamentalType::BOOLEAN);
+            break;
+        case SimpleType::INTEGER: 
+            break;
+        case SimpleType::FLOAT: 
+            desc = JVMFieldDescriptor::createFundamental(FundamentalType::FLOAT);
+            break;
+        case SimpleType::CHAR: 
+            desc = JVMFieldDescriptor::createFundamental(FundamentalType::CHAR);
+            break;
     }
-
-    assert(false);
+    // out: holder, массив из одного элемента
+    if (out) {
+        desc.addDimension();
+    }
+    return desc;
 }
 
 static bool eqAgrElTypes(std::vector<std::shared_ptr<IType>> type) {
@@ -1496,8 +1742,14 @@ ArrayType::ArrayType(const std::vector<std::pair<int, int>>& ranges,
                      std::shared_ptr<IType> type) :
     ranges_(ranges)
     , type_(type)
+    , strides_(ranges.size())
 {   
     type_->setParent(this);
+    for (auto i = ranges_.size(); i-- > 0;) {
+        strides_[i] = length_;
+        auto [l, r] = ranges_[i];
+        length_ *= r - l + 1;
+    }
 }
 
 bool ArrayType::compare(const std::shared_ptr<IType> rhs) const {
@@ -1525,9 +1777,7 @@ void ArrayType::resetType(std::shared_ptr<IType> newType) {
 descriptor::JVMFieldDescriptor 
 ArrayType::descriptor(bool out) {
     auto desc = type_->descriptor();
-    for (auto&& _ : ranges_) {
-        desc.addDimension();
-    }
+    desc.addDimension();
     return desc;
 }
 
@@ -1553,13 +1803,9 @@ std::pair<int, int> StringType::range() const {
 }
 
 descriptor::JVMFieldDescriptor StringType::descriptor(bool out) {
-    static attribute::QualifiedName builder;
-    if (builder.size() == 0) {
-        builder.push("java");
-        builder.push("lang");
-        builder.push("StringBuilder");
-    }
-    auto desc = descriptor::JVMFieldDescriptor::createObject(builder);
+    auto desc = descriptor::JVMFieldDescriptor::createFundamental(
+        codegen::FundamentalType::CHAR);
+    desc.addDimension();
     return desc;
 }
 
@@ -1666,6 +1912,54 @@ bool Op::compareTypes(const std::shared_ptr<IType> comp) {
         return false;
     }
 }
+
+// $concat([C[C)[C в inner_subprograms: длины - arraylength,
+// содержимое - System.arraycopy
+static class_member::SharedPtrMethod concatMethod() {
+    static class_member::SharedPtrMethod m;
+    if (m) {
+        return m;
+    }
+
+    auto chars = descriptor::JVMFieldDescriptor::createFundamental(
+        codegen::FundamentalType::CHAR);
+    chars.addDimension();
+    m = codegen::InnerSubprograms->addMethod("$concat",
+        descriptor::JVMMethodDescriptor::create({{"a", chars}, {"b", chars}}, chars), 
+        true);
+    m->addFlag(codegen::java_bytecode_codegen::AccessFlag::ACC_PUBLIC);
+    m->addFlag(codegen::java_bytecode_codegen::AccessFlag::ACC_STATIC);
+    m->createLocalRef("dst");
+    auto* bb = m->createBB();
+    m->createAload(bb, "a");
+    m->createArraylength(bb);
+    m->createAload(bb, "b");
+    m->createArraylength(bb);
+    m->createIadd(bb);
+    m->createNewarray(bb, codegen::ArrayType::CHAR);
+    m->createAstore(bb, "dst");
+    // a -> dst[0..]
+    m->createAload(bb, "a");
+    m->createIconst(bb, 0);
+    m->createAload(bb, "dst");
+    m->createIconst(bb, 0);
+    m->createAload(bb, "a");
+    m->createArraylength(bb);
+    m->createInvokestatic(bb, codegen::JavaSystemArraycopy);
+    // b -> dst[a.length..]
+    m->createAload(bb, "b");
+    m->createIconst(bb, 0);
+    m->createAload(bb, "dst");
+    m->createAload(bb, "a");
+    m->createArraylength(bb);
+    m->createAload(bb, "b");
+    m->createArraylength(bb);
+    m->createInvokestatic(bb, codegen::JavaSystemArraycopy);
+    m->createAload(bb, "dst");
+    m->createAreturn(bb);
+    return m;
+}
+
 // (x || y) && z => x || y && z 
 
 // если текущий op != or -> не передаем дальше bodybb, nextbb
@@ -1728,42 +2022,20 @@ bb::BasicBlock* Op::codegen(
     static auto STRING_TY  = std::make_shared<StringType>(std::make_pair(-1, -1));
     STRING_TY->setInf();
 
-    auto makeBoolResult = [&](OpType op, bool isFloat)
+    auto makeBoolResult = [&]()
     {
         auto trueBB  = method->createBB();
         auto falseBB = method->createBB();
         auto endBB = method->createBB();
         retbb = endBB;
 
-        if (isFloat) {
-            method->createFcmpl(bb);
-            switch (op) {
-                case OpType::EQ:  method->createIfeq(bb, trueBB); break;
-                case OpType::NEQ: method->createIfne(bb, trueBB); break;
-                case OpType::MORE:method->createIfgt(bb, trueBB); break;
-                case OpType::LESS:method->createIflt(bb, trueBB); break;
-                case OpType::GTE: method->createIfge(bb, trueBB); break;
-                case OpType::LTE: method->createIfle(bb, trueBB); break;
-                default: break;
-            }
-        } else {
-            switch (op) {
-                case OpType::EQ:  method->createIficmpeq(bb, trueBB); break;
-                case OpType::NEQ: method->createIficmpne(bb, trueBB); break;
-                case OpType::MORE:method->createIficmpgt(bb, trueBB); break;
-                case OpType::LESS:method->createIficmplt(bb, trueBB); break;
-                case OpType::GTE: method->createIficmpge(bb, trueBB); break;
-                case OpType::LTE: method->createIficmple(bb, trueBB); break;
-                default: break;
-            }
-        }
-
+        createCmpBranch_(bb, method, trueBB);
         method->createGoto(bb, falseBB); 
 
-        method->createLdc(trueBB, 1);
+        method->createIconst(trueBB, 1);
         method->createGoto(trueBB, endBB);
 
-        method->createLdc(falseBB, 0);
+        method->createIconst(falseBB, 0);
         method->createGoto(falseBB, endBB);
     };
 
@@ -1841,14 +2113,11 @@ bb::BasicBlock* Op::codegen(
         case OpType::LESS:
         case OpType::GTE:
         case OpType::LTE:
-        {
-            bool isFloat = FLOAT_TY->compare(lhs_->type());
-            makeBoolResult(opType_, isFloat);
+            makeBoolResult();
             break;
-        }
         case OpType::AMPER:
             assert(STRING_TY->compare(type()));
-            method->createInvokestatic(bb, codegen::AdaUtilityConcat);
+            method->createInvokestatic(bb, concatMethod());
             break;
 
         default:
@@ -1858,6 +2127,62 @@ bb::BasicBlock* Op::codegen(
     return retbb;
 }
 
+bb::BasicBlock* Op::branchCodegen(
+    bb::BasicBlock* bb, 
+    class_member::SharedPtrMethod method,
+    bb::BasicBlock* trueBB)
+{
+    bb = lhs_->codegen(bb, method);
+    bb = rhs_->codegen(bb, method);
+    createCmpBranch_(bb, method, trueBB);
+    return bb;
+}
+
+bool Op::isRelational() const noexcept {
+    switch (opType_) {
+        case OpType::EQ:
+        case OpType::NEQ:
+        case OpType::MORE:
+        case OpType::LESS:
+        case OpType::GTE:
+        case OpType::LTE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void Op::createCmpBranch_(
+    bb::BasicBlock* bb, 
+    class_member::SharedPtrMethod method,
+    bb::BasicBlock* trueBB)
+{
+    static auto FLOAT_TY = std::make_shared<SimpleLiteralType>(SimpleType::FLOAT);
+
+    if (FLOAT_TY->compare(lhs_->type())) {
+        method->createFcmpl(bb);
+        switch (opType_) {
+            case OpType::EQ:  method->createIfeq(bb, trueBB); break;
+            case OpType::NEQ: method->createIfne(bb, trueBB); break;
+            case OpType::MORE:method->createIfgt(bb, trueBB); break;
+            case OpType::LESS:method->createIflt(bb, trueBB); break;
+            case OpType::GTE: method->createIfge(bb, trueBB); break;
+            case OpType::LTE: method->createIfle(bb, trueBB); break;
+            default: break;
+        }
+    } else {
+        switch (opType_) {
+            case OpType::EQ:  method->createIficmpeq(bb, trueBB); break;
+            case OpType::NEQ: method->createIficmpne(bb, trueBB); break;
+            case OpType::MORE:method->createIficmpgt(bb, trueBB); break;
+            case OpType::LESS:method->createIficmplt(bb, trueBB); break;
+            case OpType::GTE: method->createIficmpge(bb, trueBB); break;
+            case OpType::LTE: method->createIficmple(bb, trueBB); break;
+            default: break;
+        }
+    }
+}
+
 // >,<,=,!= только с float, bool, integer, char
 // not and or xor только с bool 
 std::shared_ptr<IType> Op::type() { 
@@ -2030,69 +2355,12 @@ bb::BasicBlock* GetVarExpr::codegen(
     bool lhs, 
     int callStage) 
 {
-    // если lhs и !right_ - лоад, иначе стор
-    // если out и param и примитивный тип то - лоад через fromAtomic, стор через setAtomic
-
-    auto sTy = std::dynamic_pointer_cast<SimpleLiteralType>(var_->type());
-    const int PRE_CALL = 1;
-    const int POST_CALL = 2; 
-    if (PRE_CALL == callStage && !right_ && !(var_->out() && var_->param())) {
-        var_->createRef(bb, method);
-        return bb;
-    } else if (PRE_CALL == callStage && !right_) {
-        var_->createLoad(bb, method);
-        return bb;
-    }
-    
-    if (POST_CALL == callStage && !right_ && !(var_->out() && var_->param())) {
-        var_->loadFromRef(bb, method);
-        return bb;
-    } else if (POST_CALL == callStage && !right_) {
-        return bb;
-    }
-
+    // если lhs и !right_ - стор, иначе лоад
+    // (скалярные out параметры - см. VarDecl::holder)
     if (lhs && !right_) {
-        if (sTy && var_->out() && var_->param()) {
-            // ... rhs, lhs_atomic_ref -> ... lhs_atomic_ref, rhs 
-            var_->createLoad(bb, method); 
-            method->createSwap(bb); 
-            switch (sTy->type()) {
-                case SimpleType::BOOL:
-                    method->createInvokestatic(bb, codegen::AdaUtilitySetAtomicBoolean);
-                    break;
-                case SimpleType::CHAR:
-                    method->createInvokestatic(bb, codegen::AdaUtilitySetAtomicChar);
-                    break;
-                case SimpleType::FLOAT:
-                    method->createInvokestatic(bb, codegen::AdaUtilitySetAtomicFloat);
-                    break;
-                case SimpleType::INTEGER:
-                    method->createInvokestatic(bb, codegen::AdaUtilitySetAtomicInt);
-                    break;
-            }
-        } else {
-            var_->createStore(bb, method);
-        } 
+        var_->createStore(bb, method);
     } else if (!right_) {
-        if (sTy && var_->out() && var_->param()) {
-            var_->createLoad(bb, method); 
-            switch (sTy->type()) {
-                case SimpleType::BOOL:
-                    method->createInvokestatic(bb, codegen::AdaUtilityFromAtomicBoolean);
-                    break;
-                case SimpleType::CHAR:
-                    method->createInvokestatic(bb, codegen::AdaUtilityFromAtomicChar);
-                    break;
-                case SimpleType::FLOAT:
-                    method->createInvokestatic(bb, codegen::AdaUtilityFromAtomicFloat);
-                    break;
-                case SimpleType::INTEGER:
-                    method->createInvokestatic(bb, codegen::AdaUtilityFromAtomicInt);
-                    break;
-            }
-        } else {
-            var_->createLoad(bb, method);
-        } 
+        var_->createLoad(bb, method);
     } else {
         var_->createLoad(bb, method);
         return right_->codegen(bb, method, lhs, callStage);
@@ -2210,6 +2478,134 @@ std::shared_ptr<VarDecl> GetArrElementExpr::arr() {
     return arr_;
 }
 
+// ... idx -> ... idx * stride
+static void cgScale(
+    bb::BasicBlock* bb, 
+    class_member::SharedPtrMethod method,
+    int stride)
+{
+    if (!std::has_single_bit(static_cast<unsigned>(stride))) {
+        method->createLdc(bb, stride);
+        method->createImul(bb);
+    } else if (1 != stride) {
+        method->createLdc(bb, std::countr_zero(static_cast<unsigned>(stride)));
+        method->createIshl(bb);
+    }
+}
+
+// $checkIndex(III)I в inner_subprograms: lo <= i <= hi -> i,
+// иначе ArrayIndexOutOfBoundsException
+static class_member::SharedPtrMethod checkIndexMethod() {
+    static class_member::SharedPtrMethod m;
+    if (m) {
+        return m;
+    }
+
+    auto i32 = descriptor::JVMFieldDescriptor::createFundamental(
+        codegen::FundamentalType::INT);
+    m = codegen::InnerSubprograms->addMethod("$checkIndex",
+        descriptor::JVMMethodDescriptor::create(
+            {{"i", i32}, {"lo", i32}, {"hi", i32}}, i32), 
+        true);
+    m->addFlag(codegen::java_bytecode_codegen::AccessFlag::ACC_PUBLIC);
+    m->addFlag(codegen::java_bytecode_codegen::AccessFlag::ACC_STATIC);
+    auto* loBB = m->createBB();
+    auto* hiBB = m->createBB();
+    auto* okBB = m->createBB();
+    auto* failBB = m->createBB();
+    m->createIload(loBB, "i");
+    m->createIload(loBB, "lo");
+    m->createIficmplt(loBB, failBB);
+    m->createIload(hiBB, "i");
+    m->createIload(hiBB, "hi");
+    m->createIficmpgt(hiBB, failBB);
+    m->createIload(okBB, "i");
+    m->createIreturn(okBB);
+    m->createNew(failBB, codegen::JavaIndexException);
+    m->createDup(failBB);
+    m->createInvokespecial(failBB, codegen::JavaIndexExceptionInit);
+    m->createAthrow(failBB);
+    return m;
+}
+
+// литерал из диапазона проверять не нужно
+static bool staticallyInRange(
+    const std::shared_ptr<IExpr>& idx,
+    std::pair<int, int> range)
+{
+    auto lit = std::dynamic_pointer_cast<SimpleLiteral>(idx);
+    if (!lit || SimpleType::INTEGER != lit->literalType()) {
+        return false;
+    }
+    auto v = lit->get<int>();
+    return range.first <= v && v <= range.second;
+}
+
+// ... idx -> ... idx, проверенный по диапазону измерения
+static void cgCheckIndex(
+    bb::BasicBlock* bb, 
+    class_member::SharedPtrMethod method,
+    const std::shared_ptr<IExpr>& idx,
+    std::pair<int, int> range)
+{
+    if (staticallyInRange(idx, range)) {
+        return;
+    }
+    method->createLdc(bb, range.first);
+    method->createLdc(bb, range.second);
+    method->createInvokestatic(bb, checkIndexMethod());
+}
+
+// плоский индекс: шаги и смещение - константы типа;
+// выход за границы первого измерения ловит сама JVM (плоский индекс
+// вне массива), остальные измерения проверяются явно, иначе 
+// a(1, hi + 1) молча читал бы a(2, lo)
+bb::BasicBlock* GetArrElementExpr::cgIndex_(
+    bb::BasicBlock* bb, 
+    class_member::SharedPtrMethod method,
+    std::size_t skip,
+    bool check)
+{
+    auto arrTy = std::dynamic_pointer_cast<ArrayType>(arr_->type());
+    auto&& strides = arrTy->strides();
+    int offset = 0;
+    bool first = true;
+    for (std::size_t i = 0; i < idxs_.size(); ++i) {
+        offset += arrTy->ranges()[i].first * strides[i];
+        if (skip == i) {
+            continue;
+        }
+        bb = idxs_[i]->codegen(bb, method, false);
+        if (check && 0 != i) {
+            cgCheckIndex(bb, method, idxs_[i], arrTy->ranges()[i]);
+        }
+        cgScale(bb, method, strides[i]);
+        if (!first) {
+            method->createIadd(bb);
+        }
+        first = false;
+    }
+    if (0 != offset) {
+        method->createLdc(bb, offset);
+        method->createIsub(bb);
+    }
+    return bb;
+}
+
+bb::BasicBlock* GetArrElementExpr::codegenLoopBase(
+    bb::BasicBlock* bb, 
+    class_member::SharedPtrMethod method)
+{
+    static int baseNumb = 0;
+    base_ = "base$" + std::to_string(baseNumb++);
+    method->createLocalInt(base_);
+    // без проверок: цикл может не выполниться или обращение стоит
+    // под условием, индексы проверяются в теле (см. codegen)
+    bb = cgIndex_(bb, method, loopIdx_, false);
+    method->createIstore(bb, base_);
+    return bb;
+}
+
 bb::BasicBlock* GetArrElementExpr::codegen(
     bb::BasicBlock* bb, 
     class_member::SharedPtrMethod method, 
@@ -2217,20 +2613,32 @@ bb::BasicBlock* GetArrElementExpr::codegen(
     int callStage) 
 {
     if (auto arrTy = std::dynamic_pointer_cast<ArrayType>(arr_->type())) {
-        // проходим по всем измерениям
         arr_->createLoad(bb, method);
-        for (int i = 0; i < idxs_.size() - 1; ++i) {
-            auto&& idx = idxs_[i];
-            bb = idx->codegen(bb, method, false);
-            method->createIconst(bb, 1);
-            method->createIsub(bb);
-            method->createAaload(bb);
+        if (!base_.empty()) {
+            // инвариантные индексы без побочных эффектов 
+            // (LoopIndexing::invariant_), проверяются там же, где без выноса
+            auto&& ranges = arrTy->ranges();
+            for (std::size_t i = 1; i < idxs_.size(); ++i) {
+                if (loopIdx_ == i || staticallyInRange(idxs_[i], ranges[i])) {
+                    continue;
+                }
+                bb = idxs_[i]->codegen(bb, method, false);
+                cgCheckIndex(bb, method, idxs_[i], ranges[i]);
+                method->createPop(bb);
+            }
+            // в цикле: base + iter * stride, нижние границы уже в base
+            method->createIload(bb, base_);
+            bb = idxs_[loopIdx_]->codegen(bb, method, false);
+            if (0 != loopIdx_) {
+                cgCheckIndex(bb, method, idxs_[loopIdx_], 
+                             arrTy->ranges()[loopIdx_]);
+            }
+            cgScale(bb, method, arrTy->strides()[loopIdx_]);
+            method->createIadd(bb);
+        } else {
+            bb = cgIndex_(bb, method);
         }
         // val, ref, idx -> ref, idx, var
-        // получаем последний индекс
-        bb = idxs_.back()->codegen(bb, method);
-        method->createIconst(bb, 1);
-        method->createIsub(bb);
         // загружаем или выгружаем
         auto sTy = std::dynamic_pointer_cast<SimpleLiteralType>(arrTy->type());
         if (lhs && !right_) {
@@ -2287,9 +2695,9 @@ bb::BasicBlock* GetArrElementExpr::codegen(
             method->createDup2X1(bb);
             method->createPop(bb);
             method->createPop(bb);
-            method->createInvokestatic(bb, codegen::AdaUtilitySetCharAt);
+            method->createCastore(bb);
         } else {
-            method->createInvokestatic(bb, codegen::AdaUtilityCharAt);
+            method->createCaload(bb);
         }
     }
 
@@ -2301,6 +2709,103 @@ bb::BasicBlock* GetArrElementExpr::codegen(
 }
 
 // CallExpr
+// holder'ы вызовов: локальные метода, создаются один раз в его entryBB
+// и переиспользуются; номера занятых растут во вложенных вызовах
+static int busyHolders = 0;
+
+static std::string cgHolder(
+    class_member::SharedPtrMethod method, 
+    SimpleType type)
+{
+    std::string name = "holder$";
+    auto atype = codegen::ArrayType::INT;
+    switch (type) {
+        case SimpleType::BOOL:
+            name += 'Z';
+            atype = codegen::ArrayType::BOOLEAN;
+            break;
+        case SimpleType::CHAR:
+            name += 'C';
+            atype = codegen::ArrayType::CHAR;
+            break;
+        case SimpleType::FLOAT:
+            name += 'F';
+            atype = codegen::ArrayType::FLOAT;
+            break;
+        case SimpleType::INTEGER:
+            name += 'I';
+            break;
+    }
+    name += std::to_string(busyHolders++);
+    if (!method->hasLocal(name)) {
+        method->createLocalRef(name);
+        auto* entry = method->entryBB();
+        method->createIconst(entry, 1);
+        method->createNewarray(entry, atype);
+        method->createAstore(entry, name);
+    }
+    return name;
+}
+
+// outResult вызываемой процедуры передается по значению и 
+// сохраняется из результата, остальные скалярные out - через holder
+static bb::BasicBlock* cgCall(
+    bb::BasicBlock* bb, 
+    class_member::SharedPtrMethod method,
+    std::shared_ptr<ProcBody> callee,
+    const std::vector<std::shared_ptr<VarDecl>>& formals,
+    const std::vector<std::shared_ptr<IExpr>>& actuals,
+    std::size_t first = 0)
+{
+    auto writable = [] (std::shared_ptr<IExpr> p) {
+        auto dotOp = std::dynamic_pointer_cast<DotOpExpr>(p);
+        return dotOp && std::dynamic_pointer_cast<GetVarExpr>(dotOp->tail());
+    };
+
+    auto base = busyHolders;
+    std::vector<std::pair<std::size_t, std::string>> holders;
+    for (auto i = first; i < formals.size(); ++i) {
+        auto&& p = actuals[i];
+        auto&& var = formals[i];
+        if (!var->holder()) {
+            bb = p->codegen(bb, method);
+            continue;
+        }
+        auto sTy = std::dynamic_pointer_cast<SimpleLiteralType>(var->type());
+        auto h = cgHolder(method, sTy->type());
+        method->createAload(bb, h);
+        method->createDup(bb);
+        method->createIconst(bb, 0);
+        bb = p->codegen(bb, method);
+        cgHolderStore(bb, method, sTy->type());
+        if (writable(p)) {
+            holders.emplace_back(i, h);
+        }
+    }
+
+    callee->createCall(bb, method);
+
+    if (auto res = callee->outResult()) {
+        auto it = std::find(formals.begin(), formals.end(), res);
+        assert(it != formals.end());
+        auto&& p = actuals[it - formals.begin()];
+        if (writable(p)) {
+            bb = p->codegen(bb, method, true);
+        } else {
+            method->createPop(bb);
+        }
+    }
+    for (auto&& [i, h] : holders) {
+        auto sTy = std::dynamic_pointer_cast<SimpleLiteralType>(formals[i]->type());
+        method->createAload(bb, h);
+        cgHolderLoad(bb, method, sTy->type());
+        bb = actuals[i]->codegen(bb, method, true);
+    }
+
+    busyHolders = base;
+    return bb;
+}
+
 CallExpr::CallExpr(
     std::shared_ptr<IDecl> owner, 
     std::shared_ptr<ProcBody> proc,
@@ -2385,66 +2890,10 @@ bb::BasicBlock* CallExpr::codegen(
     if (params_.size() != params.size()) {
         params.erase(params.begin());
     }
-    // обертка в атомик
-    for (int i = 0; i < params.size(); ++i) {
-        auto&& p = params_[i];
-        auto&& var = params[i];
-        bool gen = false;
-        auto dotOp = std::dynamic_pointer_cast<DotOpExpr>(p);
-        std::shared_ptr<GetVarExpr> getVar;
-        if (dotOp)  {
-            getVar = std::dynamic_pointer_cast<GetVarExpr>(dotOp->tail());
-        }
-        auto sTy = std::dynamic_pointer_cast<SimpleLiteralType>(p->type());
-
-        bool isRef = sTy && var->param() && var->out();
-        if (getVar && isRef) {
-            int callSt = var->out() ? 1 : -1;
-            bb = p->codegen(bb, method, false, callSt);
-            gen = true;
-        } else if (isRef) {
-            bb = p->codegen(bb, method);
-            gen = true;
-            switch (sTy->type()) {
-                case SimpleType::BOOL:
-                    method->createInvokestatic(bb, codegen::AdaUtilityToAtomicBoolean);
-                    break;
-                case SimpleType::CHAR:
-                    method->createInvokestatic(bb, codegen::AdaUtilityToAtomicChar);
-                    break;
-                case SimpleType::FLOAT:
-                    method->createInvokestatic(bb, codegen::AdaUtilityToAtomicFloat);
-                    break;
-                case SimpleType::INTEGER:
-                    method->createInvokestatic(bb, codegen::AdaUtilityToAtomicInt);
-                    break;
-            }
-        }
-
-        if (!gen) bb = p->codegen(bb, method);
-    }
-
     if (noValue_) {
-        proc_->createCall(bb, method);
+        bb = cgCall(bb, method, proc_, params, params_);
     } else {
-        func_->createCall(bb, method);
-    }
-
-    // загрузка из атомика
-    for (int i = 0; i < params.size(); ++i) {
-        auto&& p = params_[i];
-        auto&& var = params[i];
-        auto dotOp = std::dynamic_pointer_cast<DotOpExpr>(p);
-        std::shared_ptr<GetVarExpr> getVar;
-        if (dotOp)  {
-            getVar = std::dynamic_pointer_cast<GetVarExpr>(dotOp->tail());
-        }
-        auto sTy = std::dynamic_pointer_cast<SimpleLiteralType>(p->type());
-        bool isRef = sTy && var->param() && var->out();
-        if (getVar && isRef) {
-            int callSt = var->out() ? 2 : -1;
-            bb = p->codegen(bb, method, false, callSt);
-        }
+        bb = cgCall(bb, method, func_, params, params_);
     }
 
     if (right_) {
@@ -2542,66 +2991,10 @@ bb::BasicBlock* CallMethodExpr::codegen(
     if (params_.size() != params.size()) {
         params.erase(params.begin());
     }
-    // обертка в атомик
-    for (; i < params.size(); ++i) {
-        auto&& p = params_[i];
-        auto&& var = params[i];
-        bool gen = false;
-        auto dotOp = std::dynamic_pointer_cast<DotOpExpr>(p);
-        std::shared_ptr<GetVarExpr> getVar;
-        if (dotOp)  {
-            getVar = std::dynamic_pointer_cast<GetVarExpr>(dotOp->tail());
-        }
-        auto sTy = std::dynamic_pointer_cast<SimpleLiteralType>(p->type());
-
-        bool isRef = sTy && var->param() && var->out();
-        if (getVar && isRef) {
-            int callSt = var->out() ? 1 : -1;
-            bb = p->codegen(bb, method, false, callSt);
-            gen = true;
-        } else if (isRef) {
-            bb = p->codegen(bb, method);
-            gen = true;
-            switch (sTy->type()) {
-                case SimpleType::BOOL:
-                    method->createInvokestatic(bb, codegen::AdaUtilityToAtomicBoolean);
-                    break;
-                case SimpleType::CHAR:
-                    method->createInvokestatic(bb, codegen::AdaUtilityToAtomicChar);
-                    break;
-                case SimpleType::FLOAT:
-                    method->createInvokestatic(bb, codegen::AdaUtilityToAtomicFloat);
-                    break;
-                case SimpleType::INTEGER:
-                    method->createInvokestatic(bb, codegen::AdaUtilityToAtomicInt);
-                    break;
-            }
-        }
-
-        if (!gen) bb = p->codegen(bb, method);
-    }
-
     if (noValue_) {
-        proc_->createCall(bb, method);
+        bb = cgCall(bb, method, proc_, params, params_, i);
     } else {
-        func_->createCall(bb, method);
-    }
-
-    // загрузка из атомика
-    for (int i = 0; i < params.size(); ++i) {
-        auto&& p = params_[i];
-        auto&& var = params[i];
-        auto dotOp = std::dynamic_pointer_cast<DotOpExpr>(p);
-        std::shared_ptr<GetVarExpr> getVar;
-        if (dotOp)  {
-            getVar = std::dynamic_pointer_cast<GetVarExpr>(dotOp->tail());
-        }
-        auto sTy = std::dynamic_pointer_cast<SimpleLiteralType>(p->type());
-        bool isRef = sTy && var->param() && var->out();
-        if (getVar && isRef) {
-            int callSt = var->out() ? 2 : -1;
-            bb = p->codegen(bb, method, false, callSt);
-        }
+        bb = cgCall(bb, method, func_, params, params_, i);
     }
 
     if (right_) {
@@ -2631,6 +3024,11 @@ std::shared_ptr<IExpr> ImageCallExpr::param() {
     return param_;
 }
 
+void ImageCallExpr::setParam(std::shared_ptr<IExpr> param) {
+    param_ = param;
+    param_->setParent(parent_);
+}
+
 std::shared_ptr<SimpleLiteralType> ImageCallExpr::imageType() {
     return imageType_;
 }
@@ -2666,7 +3064,7 @@ bb::BasicBlock* ImageCallExpr::codegen(
 }
 
 // NameExpr
-NameExpr::NameExpr(const std::string& name) :
+NameExpr::NameExpr(const attribute::Symbol& name) :
     name_(name)
 {}
 
@@ -2744,17 +3142,48 @@ std::shared_ptr<IType> StringLiteral::type() {
 }
 
 // codegen
+// литерал - общий char[] в static final поле inner_subprograms,
+// по одному на текст; присваивание и return копируют его (cgCopy)
+static std::unordered_map<std::string, class_member::SharedPtrField> literalFields;
+static std::vector<std::pair<std::string, class_member::SharedPtrField>> literalOrder;
+
 bb::BasicBlock* StringLiteral::codegen(
         bb::BasicBlock* bb, 
         class_member::SharedPtrMethod method, 
         bool lhs,
         int callStage) 
 {
-    method->createLdc(bb, str_);   
-    method->createInvokestatic(bb, codegen::AdaUtilityFromStringLiteral);
+    auto it = literalFields.find(str_);
+    if (it == literalFields.end()) {
+        auto name = "$str" + std::to_string(literalOrder.size());
+        auto field = codegen::InnerSubprograms->addField(name, type_->descriptor());
+        field->addFlag(codegen::java_bytecode_codegen::AccessFlag::ACC_PUBLIC);
+        field->addFlag(codegen::java_bytecode_codegen::AccessFlag::ACC_STATIC);
+        field->addFlag(codegen::java_bytecode_codegen::AccessFlag::ACC_FINAL);
+        it = literalFields.emplace(str_, field).first;
+        literalOrder.emplace_back(str_, field);
+    }
+    method->createGetstatic(bb, it->second);
     return bb;
 }
 
+void StringLiteral::codegenCache() {
+    if (literalOrder.empty()) {
+        return;
+    }
+    auto clinit = codegen::InnerSubprograms->addMethod("<clinit>", 
+        descriptor::JVMMethodDescriptor::createVoidParamsVoidReturn(), true);
+    clinit->removeFlag(codegen::AccessFlag::ACC_PUBLIC);
+    clinit->addFlag(codegen::AccessFlag::ACC_STATIC);
+    auto* bb = clinit->createBB();
+    for (auto&& [str, field] : literalOrder) {
+        clinit->createLdc(bb, str);
+        clinit->createInvokevirtual(bb, codegen::JavaStringToCharArray);
+        clinit->createPutstatic(bb, field);
+    }
+    clinit->createReturn(bb);
+}
+
 } // namespace node 
 
 // Stms - Control Structure
@@ -2795,6 +3224,23 @@ void If::setParent(INode* parent) {
 }
 
 // codegen
+// условие if/while: сравнение - сразу переходом на trueBB,
+// остальное - через 0/1 на стеке и ifne
+static bb::BasicBlock* condCodegen(
+    std::shared_ptr<IExpr> cond,
+    bb::BasicBlock* bb, 
+    class_member::SharedPtrMethod method,
+    bb::BasicBlock* trueBB)
+{
+    auto op = std::dynamic_pointer_cast<Op>(cond);
+    if (op && op->isRelational()) {
+        return op->branchCodegen(bb, method, trueBB);
+    }
+    bb = cond->codegen(bb, method);
+    method->createIfne(bb, trueBB);
+    return bb;
+}
+
 bb::BasicBlock* If::codegen(
     bb::BasicBlock* bb, 
     class_member::SharedPtrMethod method)
@@ -2813,9 +3259,7 @@ bb::BasicBlock* If::codegen(
         op->setBodyBB(bodyBB);
     }
 
-    auto* nextCondBB = cond_->codegen(condBB, method);
-    auto op = std::dynamic_pointer_cast<Op>(cond_);
-    method->createIfne(nextCondBB, bodyBB);
+    condCodegen(cond_, condBB, method, bodyBB);
     auto* nextNextCondBB = method->createBB();
     if (auto op = std::dynamic_pointer_cast<Op>(cond_)) {
         op->setNextBB(nextNextCondBB, method);
@@ -2834,9 +3278,7 @@ bb::BasicBlock* If::codegen(
             op->setBodyBB(bodyBB);
         }
 
-        auto* nextCondBB = c->codegen(condBB, method);
-        auto op = std::dynamic_pointer_cast<Op>(c);
-        method->createIfne(nextCondBB, bodyBB);
+        condCodegen(c, condBB, method, bodyBB);
         
         nextNextCondBB = method->createBB();
         if (auto op = std::dynamic_pointer_cast<Op>(c)) {
@@ -2857,7 +3299,7 @@ bb::BasicBlock* If::codegen(
 }
 
 // For
-For::For(const std::string& init, 
+For::For(const attribute::Symbol& init, 
          std::pair<std::shared_ptr<IExpr>, std::shared_ptr<IExpr>> range, 
          std::shared_ptr<Body> body) :
     init_(init)
@@ -2891,6 +3333,10 @@ bb::BasicBlock* For::codegen(
     method->createLocalInt(right);
     bb = range_.second->codegen(bb, method);
     method->createIstore(bb, right);
+
+    for (auto&& idx : hoisted_) {
+        bb = idx->codegenLoopBase(bb, method);
+    }
     
     // создаем бб конда и тела
     auto* condBB = method->createBB();
@@ -2945,9 +3391,7 @@ bb::BasicBlock* While::codegen(
         op->setBodyBB(bodyBB);
     }
 
-    auto* nextCondBB = cond_->codegen(condBB, method);
-    auto op = std::dynamic_pointer_cast<Op>(cond_);
-    method->createIfne(nextCondBB, bodyBB);
+    condCodegen(cond_, condBB, method, bodyBB);
     auto* nextNextCondBB = method->createBB();
     if (auto op = std::dynamic_pointer_cast<Op>(cond_)) {
         op->setNextBB(nextNextCondBB, method);
@@ -3068,16 +3512,13 @@ bb::BasicBlock* Assign::codegen(
     auto str = std::dynamic_pointer_cast<StringType>(rval_->type());
     auto agr = std::dynamic_pointer_cast<AggregateType>(rval_->type());
 
-    rval_->codegen(bb, method);
-    if (rec && !std::dynamic_pointer_cast<SuperclassReference>(lval_->type())) {
-        method->createInvokestatic(bb, codegen::AdaUtilityDeepCopy);
-        method->createCheckcast(bb, rec->javaClass());
-    } else if (arr) {
-        method->createInvokestatic(bb, codegen::AdaUtilityDeepCopyArray);
-        auto desc = arr->descriptor();
-        method->createCheckcast(bb, desc);
-    } else if (str) {
-        method->createInvokestatic(bb, codegen::AdaUtilityCopyStringBuilder);
+    bb = rval_->codegen(bb, method);
+    // owned значение забирается без копии (CopyElision)
+    auto copy = !rval_->owned();
+    if (copy && rec && !std::dynamic_pointer_cast<SuperclassReference>(lval_->type())) {
+        bb = cgCopy(bb, method, rec);
+    } else if (copy && (arr || str)) {
+        bb = cgCopy(bb, method, rval_->type());
     }
 
     if (!agr) {
@@ -3113,15 +3554,8 @@ bb::BasicBlock* Return::codegen(
         auto rec = std::dynamic_pointer_cast<RecordDecl>(retVal_->type());
         auto arr = std::dynamic_pointer_cast<ArrayType>(retVal_->type());
         auto str = std::dynamic_pointer_cast<StringType>(retVal_->type());
-        if (rec) {
-            method->createInvokestatic(bb, codegen::AdaUtilityDeepCopy);
-            method->createCheckcast(bb, rec->javaClass());
-        } else if (arr) {
-            method->createInvokestatic(bb, codegen::AdaUtilityDeepCopyArray);
-            auto desc = arr->descriptor();
-            method->createCheckcast(bb, desc);
-        } else if (str) {
-            method->createInvokestatic(bb, codegen::AdaUtilityCopyStringBuilder);
+        if (!retVal_->owned()) {
+            bb = cgCopy(bb, method, retVal_->type());
         }
 
         if (rec || arr || str) {
@@ -3136,6 +3570,8 @@ bb::BasicBlock* Return::codegen(
                     break;
             }
         } 
+    } else if (auto proc = dynamic_cast<ProcBody*>(parent())) {
+        proc->createReturn(bb, method);
     } else {
         method->createReturn(bb);
     }  
@@ -3153,7 +3589,7 @@ ClassDecl::ClassDecl(std::shared_ptr<RecordDecl> record) :
     name_(record->name() + "Class")
 {}
 
-const std::string& ClassDecl::name() const noexcept {
+const attribute::Symbol& ClassDecl::name() const noexcept {
     return name_;
 }
 
@@ -3182,7 +3618,7 @@ void ClassDecl::addMethod(std::shared_ptr<ProcBody> method) {
 }
 
 std::shared_ptr<ProcBody> ClassDecl::containsMethod(
-    const std::string& name, 
+    const attribute::Symbol& name, 
     const std::vector<std::shared_ptr<IType>>& params,
     bool proc)
 {   
@@ -3231,14 +3667,14 @@ std::shared_ptr<ProcBody> ClassDecl::containsMethod(
     }
 }
 
-std::shared_ptr<ProcBody> ClassDecl::proc(const std::string& name) {
+std::shared_ptr<ProcBody> ClassDecl::proc(const attribute::Symbol& name) {
     auto it = std::find_if(procs_.begin(), procs_.end(), 
     [&name] (auto&& p) { return p.lock()->name() == name;} );
     
     return it == procs_.end() ? nullptr : it->lock();
 }  
 
-std::shared_ptr<FuncBody> ClassDecl::func(const std::string& name) {
+std::shared_ptr<FuncBody> ClassDecl::func(const attribute::Symbol& name) {
     auto it = std::find_if(funcs_.begin(), funcs_.end(), 
     [&name] (auto&& p) { return p.lock()->name() == name;});
     
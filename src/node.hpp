@@ -10,6 +10,10 @@
 #include <variant>
 #include <memory>
 #include <map>
+#include <span>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
 
 // inteface
 namespace node {    
@@ -92,7 +96,7 @@ class RecordDecl;
 class GlobalSpace;
 class IDecl : virtual public INode { 
 public: 
-    virtual const std::string& name() const noexcept = 0;
+    virtual const attribute::Symbol& name() const noexcept = 0;
 
     virtual std::vector<
         std::vector<std::shared_ptr<IDecl>>> 
@@ -133,8 +137,8 @@ protected:
     virtual void reachable_(
         std::vector<
             std::vector<std::shared_ptr<IDecl>>>& res,
-        std::vector<std::string>::const_iterator it,
-        std::vector<std::string>::const_iterator end,
+        attribute::QualifiedName::const_iterator it,
+        attribute::QualifiedName::const_iterator end,
         IDecl* requester) = 0;
 
     attribute::QualifiedName fullName_; 
@@ -164,6 +168,11 @@ struct IExpr : INode {
     bool noAnalyse() { return noAnalyse_; }
     void setNoAnalyse() { noAnalyse_ = true;} 
 
+    // значение больше никому не принадлежит (см. CopyElision):
+    // присваивание, инициализация и return забирают ссылку без копии
+    bool owned() const noexcept { return owned_; }
+    void setOwned() noexcept { owned_ = true; }
+
 public: // codegen
     [[nodiscard]]
     virtual bb::BasicBlock* codegen(
@@ -177,6 +186,7 @@ private:
     bool inBrackets_ = false;
     VarDecl* varDecl_ = nullptr;
     bool noAnalyse_ = false;
+    bool owned_ = false;
 };
 
 class ILiteral : public IExpr { /*...*/ };
@@ -220,31 +230,53 @@ class DeclArea : public INode {
 public:
     void addDeclToFront(std::shared_ptr<IDecl> decl) {
         decls_.insert(decls_.begin(), decl);
+        indexed_ = false;
     }
     void addDecl(std::shared_ptr<IDecl> decl);
     void removeDecl(std::shared_ptr<IDecl> decl);
 
     void replaceDecl(
-        const std::string& name, 
+        const attribute::Symbol& name, 
         std::shared_ptr<IDecl> decl);
 
     std::vector<std::shared_ptr<IDecl>>::iterator begin();
     std::vector<std::shared_ptr<IDecl>>::iterator end();
 
+    // объявления с именем name в порядке объявления;
+    // если requester из этой области - только объявленные не позже него
+    std::span<const std::shared_ptr<IDecl>> visible(
+        const attribute::Symbol& name, 
+        const IDecl* requester = nullptr);
+
     void setParent(INode* parent) override;
 
 public: // INode interface
     void print(graphviz::GraphViz& gv, 
                        graphviz::VertexType par) const override;
 
+private:
+    void buildIndex_();
 
 private:
     std::vector<std::shared_ptr<IDecl>> decls_;
+
+    // хэш-индекс по именам, перестраивается 
+    // при первом поиске после изменения decls_;
+    // поиск может идти из параллельных проходов по модулям,
+    // поэтому перестройка под indexMutex_
+    struct Named_ {
+        std::vector<std::size_t> pos;
+        std::vector<std::shared_ptr<IDecl>> decls;
+    };
+    std::unordered_map<attribute::Symbol, Named_> index_;
+    std::unordered_map<const IDecl*, std::size_t> pos_;
+    std::atomic<bool> indexed_ = false;
+    std::mutex indexMutex_;
 };
 
 class VarDecl : public IDecl {
 public:
-    VarDecl(const std::string& name, 
+    VarDecl(const attribute::Symbol& name, 
             std::shared_ptr<IType> type, 
             std::shared_ptr<IExpr> rval = nullptr);
     
@@ -261,6 +293,10 @@ public:
     bool param() const noexcept { return param_; }
     bool aliasType() const noexcept { return aliasType_; }
 
+    // constant: присваивать нельзя (как не-out переменной)
+    void setConstant() noexcept { constant_ = true; out_ = false; }
+    bool constant() const noexcept { return constant_; }
+
 public: // codegen
     void pregen(
         jvm_class::SharedPtrJVMClass cls, 
@@ -280,14 +316,10 @@ public: // codegen
     void createStore(
         bb::BasicBlock* bb, 
         class_member::SharedPtrMethod method);
-    // stack: ... obj->var
-    // лоад создание рефа, загрузка лоада в реф
-    void createRef(bb::BasicBlock* bb, 
-                   class_member::SharedPtrMethod method);
-    // stack: ... obj->var
-    // получение из рефа, стор
-    void loadFromRef(bb::BasicBlock* bb,
-                     class_member::SharedPtrMethod method);
+
+    // скалярный out параметр, передаваемый в массиве из
+    // одного элемента (см. ProcBody::outResult)
+    bool holder() noexcept;
 
     auto nextBB() noexcept { return nextBB_; }
 
@@ -303,8 +335,8 @@ public: // INode interface
     }
 
 public: // IDecl interface
-    const std::string& name() const noexcept override;
-    void setName(const std::string& name) { name_ = name; };
+    const attribute::Symbol& name() const noexcept override;
+    void setName(const attribute::Symbol& name) { name_ = name; };
 
 public:
     std::shared_ptr<IExpr> rval();
@@ -314,18 +346,19 @@ private:
     void reachable_(
         std::vector<
             std::vector<std::shared_ptr<IDecl>>>& res,
-        std::vector<std::string>::const_iterator it,
-        std::vector<std::string>::const_iterator end,
+        attribute::QualifiedName::const_iterator it,
+        attribute::QualifiedName::const_iterator end,
         IDecl* requester) override;
 
 private:
-    std::string name_;
+    attribute::Symbol name_;
     std::shared_ptr<IType> type_;
     std::shared_ptr<IExpr> rval_;
     bool in_ = true;
     bool out_ = true;
     bool param_ = false;
     bool aliasType_ = false;
+    bool constant_ = false;
 
 private: // codegen
     class_member::SharedPtrField javaField_;   // если поле
@@ -340,7 +373,7 @@ private: // codegen
 class ClassDecl;
 class ProcBody : public IDecl {
 public:
-    ProcBody(const std::string& name, 
+    ProcBody(const attribute::Symbol& name, 
              const std::vector<std::shared_ptr<VarDecl>>& params,
              std::shared_ptr<DeclArea> decls,
              std::shared_ptr<Body> body);
@@ -350,7 +383,7 @@ public: // INode interface
                        graphviz::VertexType par) const override;
 
 public: // IDecl interface
-    const std::string& name() const noexcept override;
+    const attribute::Symbol& name() const noexcept override;
 
 public:
     std::shared_ptr<DeclArea> decls();
@@ -363,6 +396,13 @@ public: // codegen
     virtual void createCall(bb::BasicBlock* bb, class_member::SharedPtrMethod method);
     virtual descriptor::JVMMethodDescriptor desc();
 
+    // единственный скалярный out параметр процедуры: передается
+    // по значению и возвращается как результат метода;
+    // nullptr для функций и при 0 или нескольких таких параметрах
+    std::shared_ptr<VarDecl> outResult() const;
+    // return, с outResult - его возврат
+    void createReturn(bb::BasicBlock* bb, class_member::SharedPtrMethod method);
+
 public: // codegen
     void pregen(
         jvm_class::SharedPtrJVMClass cls, 
@@ -389,13 +429,13 @@ protected:
     void reachable_(
         std::vector<
             std::vector<std::shared_ptr<IDecl>>>& res,
-        std::vector<std::string>::const_iterator it,
-        std::vector<std::string>::const_iterator end,
+        attribute::QualifiedName::const_iterator it,
+        attribute::QualifiedName::const_iterator end,
         IDecl* requester) override;
 
 protected:
     std::weak_ptr<ClassDecl> cls_;
-    std::string name_;
+    attribute::Symbol name_;
     std::vector<std::shared_ptr<VarDecl>> params_;
     std::shared_ptr<DeclArea> decls_;
     std::shared_ptr<Body> body_;
@@ -409,7 +449,7 @@ protected:
 
 class ProcDecl : public ProcBody {
 public:
-    ProcDecl(const std::string& name, 
+    ProcDecl(const attribute::Symbol& name, 
              const std::vector<std::shared_ptr<VarDecl>>& params = {});
 
 public: // codegen
@@ -427,7 +467,7 @@ private:
 
 class FuncBody : public ProcBody {
 public:
-    FuncBody(const std::string& name, 
+    FuncBody(const attribute::Symbol& name, 
              const std::vector<std::shared_ptr<VarDecl>>& params ,
              std::shared_ptr<DeclArea> decls,
              std::shared_ptr<Body> body,
@@ -454,7 +494,7 @@ private:
 
 class FuncDecl : public FuncBody {
 public:
-    FuncDecl(const std::string& name, 
+    FuncDecl(const attribute::Symbol& name, 
              const std::vector<std::shared_ptr<VarDecl>>& params,
              std::shared_ptr<IType> retType);
 
@@ -473,7 +513,7 @@ private:
 
 class PackDecl : public IDecl {
 public:
-    PackDecl(const std::string& name, 
+    PackDecl(const attribute::Symbol& name, 
              std::shared_ptr<DeclArea> decls,
              std::shared_ptr<DeclArea> privateDecls = nullptr);
     
@@ -486,7 +526,7 @@ public:
     std::shared_ptr<DeclArea> privateDecls();
 
 public: // IDecl interface
-    const std::string& name() const noexcept override;
+    const attribute::Symbol& name() const noexcept override;
 
 public: // codegen
     void pregen(
@@ -508,8 +548,8 @@ private:
     void reachable_(
         std::vector<
             std::vector<std::shared_ptr<IDecl>>>& res,
-        std::vector<std::string>::const_iterator it,
-        std::vector<std::string>::const_iterator end,
+        attribute::QualifiedName::const_iterator it,
+        attribute::QualifiedName::const_iterator end,
         IDecl* requester) override;
 
 protected:
@@ -517,13 +557,13 @@ protected:
     void reachableForPackBody_(
         std::vector<
             std::vector<std::shared_ptr<IDecl>>>& res,
-        std::vector<std::string>::const_iterator it,
-        std::vector<std::string>::const_iterator end,
+        attribute::QualifiedName::const_iterator it,
+        attribute::QualifiedName::const_iterator end,
         IDecl* requester);
 
 
 protected:
-    std::string name_;
+    attribute::Symbol name_;
     std::shared_ptr<DeclArea> decls_;
     std::shared_ptr<DeclArea> privateDecls_;
     std::weak_ptr<PackBody> packBody_;
@@ -547,7 +587,7 @@ protected:
 // + декл подпрог наследуется от боди и вызывает его методы * 
 class PackBody : public PackDecl {
 public:
-    PackBody(const std::string& name, 
+    PackBody(const attribute::Symbol& name, 
              std::shared_ptr<DeclArea> decls);
 
 public: // INode interface
@@ -565,8 +605,8 @@ private:
     void reachable_(
         std::vector<
             std::vector<std::shared_ptr<IDecl>>>& res,
-        std::vector<std::string>::const_iterator it,
-        std::vector<std::string>::const_iterator end,
+        attribute::QualifiedName::const_iterator it,
+        attribute::QualifiedName::const_iterator end,
         IDecl* requester) override;
 
 public:
@@ -581,7 +621,7 @@ public:
     GlobalSpace(std::shared_ptr<IDecl> unit);
 
 public:
-    const std::string& name() const noexcept override;
+    const attribute::Symbol& name() const noexcept override;
 
 public: // INode interface
     void print(graphviz::GraphViz& gv, 
@@ -601,8 +641,8 @@ private:
     void reachable_(
         std::vector<
             std::vector<std::shared_ptr<IDecl>>>& res,
-        std::vector<std::string>::const_iterator it,
-        std::vector<std::string>::const_iterator end,
+        attribute::QualifiedName::const_iterator it,
+        attribute::QualifiedName::const_iterator end,
         IDecl* requester) override;
     
 private:
@@ -649,7 +689,7 @@ class RecordDecl :
     , public IType
 {
 public:
-    RecordDecl(const std::string& name, 
+    RecordDecl(const attribute::Symbol& name, 
                std::shared_ptr<DeclArea> decls, 
                attribute::QualifiedName base = {}, 
                bool isTagged = false);
@@ -659,7 +699,7 @@ public: // INode interface
                graphviz::VertexType par) const override;
 
 public: // IDecl interface
-    const std::string& name() const noexcept override;
+    const attribute::Symbol& name() const noexcept override;
 
 public: // IType interface
     bool compare(
@@ -686,7 +726,7 @@ public:
     void setClass(std::shared_ptr<ClassDecl> cls);
 
     std::shared_ptr<VarDecl> 
-    getVarDecl(const std::string& name) {
+    getVarDecl(const attribute::Symbol& name) {
         // auto it = std::find_if(decls_->begin(), decls_->end(), 
         //     [&name](auto&& v) { return v->name() == name; } );
 
@@ -730,10 +770,17 @@ public: // codegen
 
 public: // codegen
     void setJavaClassParrent(jvm_class::SharedPtrJVMClass parent);
-    void setParentInit(class_member::SharedPtrMethod init) {
+    void setParentInit(
+        class_member::SharedPtrMethod init,
+        class_member::SharedPtrMethod copyInit) 
+    {
         baseInit_ = init;
+        baseCopyInit_ = copyInit;
     }
     class_member::SharedPtrMethod init() { return init_; };
+    // $copy()Ljava/lang/Object; - виртуальный, глубокая копия
+    // через конструктор копирования <init>(LSelf;)V
+    class_member::SharedPtrMethod copy() { return copy_; };
 
 private:
     void createJavaClass_();
@@ -742,15 +789,15 @@ private:
     void reachable_(
         std::vector<
             std::vector<std::shared_ptr<IDecl>>>& res,
-        std::vector<std::string>::const_iterator it,
-        std::vector<std::string>::const_iterator end,
+        attribute::QualifiedName::const_iterator it,
+        attribute::QualifiedName::const_iterator end,
         IDecl* requester) override;
 
 private:
     std::weak_ptr<RecordDecl> baseRecord_;
     std::vector<std::shared_ptr<RecordDecl>> deriveRecords_;
 
-    std::string name_;
+    attribute::Symbol name_;
     std::shared_ptr<DeclArea> decls_;
     attribute::QualifiedName base_;
     bool isInherits_;
@@ -761,6 +808,9 @@ private:
     jvm_class::SharedPtrJVMClass javaClass_;
     class_member::SharedPtrMethod init_;
     class_member::SharedPtrMethod baseInit_;
+    class_member::SharedPtrMethod copyInit_;
+    class_member::SharedPtrMethod baseCopyInit_;
+    class_member::SharedPtrMethod copy_;
 };
 
 class TypeAliasDecl : 
@@ -768,7 +818,7 @@ class TypeAliasDecl :
     , public IType
 {
 public:
-    TypeAliasDecl(const std::string& name, 
+    TypeAliasDecl(const attribute::Symbol& name, 
                   std::shared_ptr<IType> type); 
 
 public: // INode interface
@@ -777,7 +827,7 @@ public: // INode interface
 
 
 public: // IDecl interface
-    const std::string& name() const noexcept override;
+    const attribute::Symbol& name() const noexcept override;
 
 public: // IType interface
     bool compare(
@@ -791,12 +841,12 @@ private:
     void reachable_(
         std::vector<
             std::vector<std::shared_ptr<IDecl>>>& res,
-        std::vector<std::string>::const_iterator it,
-        std::vector<std::string>::const_iterator end,
+        attribute::QualifiedName::const_iterator it,
+        attribute::QualifiedName::const_iterator end,
         IDecl* requester) override;
 
 private:
-    std::string name_;
+    attribute::Symbol name_;
     std::shared_ptr<IType> origin_;
 };
 
@@ -865,12 +915,20 @@ public:
     decltype(auto) ranges() const noexcept { return ranges_; }
 
 public: // codegen
+    // N-мерный массив хранится одним плоским (row-major): [T
     descriptor::JVMFieldDescriptor descriptor(
         bool ref = false) override;    
 
+    // шаг плоского индекса по каждому измерению
+    const std::vector<int>& strides() const noexcept { return strides_; }
+    // число элементов плоского массива
+    int length() const noexcept { return length_; }
+
 private:
     std::vector<std::pair<int, int>> ranges_; 
     std::shared_ptr<IType> type_;
+    std::vector<int> strides_;
+    int length_ = 1;
 };
 
 class StringType : public IType {
@@ -957,6 +1015,14 @@ public: // codgen
         bool lhs = false,
         int callStage = -1);
 
+    // сравнение в условии if/while: сразу переход на trueBB,
+    // без 0/1 на стеке; возвращает bb, где продолжается ложная ветка
+    [[nodiscard]] bb::BasicBlock* branchCodegen(
+        bb::BasicBlock* bb, 
+        class_member::SharedPtrMethod method,
+        bb::BasicBlock* trueBB);
+    bool isRelational() const noexcept;
+
     void setBodyBB(bb::BasicBlock* bb) { bodyBB_ = bb; }
     void setNextBB(bb::BasicBlock* bb, class_member::SharedPtrMethod method) { 
         if (auto op = std::dynamic_pointer_cast<Op>(lhs_)) {
@@ -967,6 +1033,13 @@ public: // codgen
         }
     }
 
+private:
+    // if_icmpXX или fcmpl + ifXX на trueBB
+    void createCmpBranch_(
+        bb::BasicBlock* bb, 
+        class_member::SharedPtrMethod method,
+        bb::BasicBlock* trueBB);
+
 private:
     std::shared_ptr<IExpr> lhs_;
     OpType opType_;
@@ -1083,6 +1156,11 @@ public:
 
 public:
     std::shared_ptr<VarDecl> arr();
+    std::vector<std::shared_ptr<IExpr>>& idxs() noexcept { return idxs_; }
+
+    // idxs_[idx] - итератор For, остальные индексы в его
+    // теле не меняются (см. LoopIndexing)
+    void setLoopIdx(std::size_t idx) noexcept { loopIdx_ = idx; }
 
 public: // IExpr interface
     std::shared_ptr<IType> type() override;
@@ -1094,6 +1172,20 @@ public: // codegen
         bool lhs = false,
         int callStage = -1) override;
 
+    // перед циклом: плоский индекс без итератора -> локальная base
+    [[nodiscard]] bb::BasicBlock* codegenLoopBase(
+        bb::BasicBlock* bb, 
+        class_member::SharedPtrMethod method);
+
+private:
+    // ... -> ... sum(idx_k * stride_k) - sum(l_k * stride_k), k != skip;
+    // check - проверка диапазонов измерений k > 0
+    bb::BasicBlock* cgIndex_(
+        bb::BasicBlock* bb, 
+        class_member::SharedPtrMethod method,
+        std::size_t skip = std::string::npos,
+        bool check = true);
+
 private:
     std::shared_ptr<IDecl> owner_; 
     std::shared_ptr<VarDecl> arr_;
@@ -1101,6 +1193,9 @@ private:
     bool container_;
     bool lhs_;
     bool rhs_;
+
+    std::size_t loopIdx_ = std::string::npos;
+    std::string base_;
 };
 
 class CallExpr : public DotOpExpr {
@@ -1119,6 +1214,7 @@ public:
 public:
     bool setNoValue();
     const std::vector<std::shared_ptr<IExpr>>& params() const noexcept;
+    std::vector<std::shared_ptr<IExpr>>& params() noexcept { return params_; }
     std::shared_ptr<ProcBody> proc();
     std::shared_ptr<FuncBody> func();
     
@@ -1157,6 +1253,7 @@ public:
 public:    
     bool setNoValue();
     const std::vector<std::shared_ptr<IExpr>>& params() const noexcept;
+    std::vector<std::shared_ptr<IExpr>>& params() noexcept { return params_; }
     std::shared_ptr<ProcBody> proc();
     std::shared_ptr<FuncBody> func();
 
@@ -1197,6 +1294,7 @@ public: // IExpr interface
 
 public:
     std::shared_ptr<IExpr> param();
+    void setParam(std::shared_ptr<IExpr> param);
     std::shared_ptr<SimpleLiteralType> imageType();
 
 public: // codegen
@@ -1214,14 +1312,14 @@ private:
 /////////////////////////////////////////////////////////////////////////////
 class NameExpr : public IExpr {
 public:
-    NameExpr(const std::string& name);
+    NameExpr(const attribute::Symbol& name);
 
 public: // INode interface
     void print(graphviz::GraphViz& gv, 
                graphviz::VertexType par) const override;
 
 public:
-    const std::string& name() const noexcept {
+    const attribute::Symbol& name() const noexcept {
         return name_;
     }
 
@@ -1233,7 +1331,7 @@ public: // IExpr interface
     { assert(false); return nullptr; }
 
 private:
-    std::string name_;
+    attribute::Symbol name_;
 };
 
 class AttributeExpr : public IExpr {
@@ -1353,6 +1451,12 @@ public:
     StringLiteral(std::shared_ptr<StringType> type, 
                   const std::string& str);
 
+    const std::string& str() const noexcept { return str_; }
+
+    // <clinit> inner_subprograms: заполняет static final поля
+    // литералов; вызывается после codegen всех модулей
+    static void codegenCache();
+
 public: // IExpr interface
     bool compareTypes(const std::shared_ptr<IType> rhs) override;
     std::shared_ptr<IType> type() override;
@@ -1432,7 +1536,7 @@ public:
     void setCond(std::shared_ptr<IExpr> cond) { cond_ = cond; }
     auto body() { return body_; }
     auto bodyElse() { return els_; }
-    decltype(auto) elsifs() { return elsifs_; } 
+    auto& elsifs() { return elsifs_; } 
 
 public: // codegen
     [[nodiscard]] bb::BasicBlock* codegen(
@@ -1449,7 +1553,7 @@ private:
 
 class For : public IStm {
 public:
-    For(const std::string& init, 
+    For(const attribute::Symbol& init, 
         std::pair<std::shared_ptr<IExpr>,
                      std::shared_ptr<IExpr>> range, 
         std::shared_ptr<Body> body);
@@ -1465,6 +1569,7 @@ public:
     void setIter(std::shared_ptr<VarDecl> iter) {
         iter_ = iter;
     }
+    auto iter() { return iter_; }
     auto range() { return range_; }
     void setRange(
         std::pair<std::shared_ptr<IExpr>, 
@@ -1474,17 +1579,23 @@ public:
     }
     auto body() { return body_; }
 
+    // база индекса idx вычисляется один раз до цикла
+    void hoist(std::shared_ptr<GetArrElementExpr> idx) {
+        hoisted_.push_back(idx);
+    }
+
 public: // codegen
     [[nodiscard]] bb::BasicBlock* codegen(
         bb::BasicBlock* bb, 
         class_member::SharedPtrMethod method) override;
 
 private:
-    std::string init_;
+    attribute::Symbol init_;
     std::shared_ptr<VarDecl> iter_;
     std::pair<std::shared_ptr<IExpr>,
                  std::shared_ptr<IExpr>> range_; 
     std::shared_ptr<Body> body_;
+    std::vector<std::shared_ptr<GetArrElementExpr>> hoisted_;
 };
 
 class While : public IStm {
@@ -1636,7 +1747,7 @@ public:
     ClassDecl(std::shared_ptr<RecordDecl> record);
 
 public: // IDecl interface
-    const std::string& name() const noexcept override;
+    const attribute::Symbol& name() const noexcept override;
 
 public: // INode interface
     void print(graphviz::GraphViz& gv, 
@@ -1652,12 +1763,12 @@ public:
     bool isDerivedOf(std::shared_ptr<ClassDecl> cls);
 
     std::shared_ptr<ProcBody> containsMethod(
-        const std::string& name, 
+        const attribute::Symbol& name, 
         const std::vector<std::shared_ptr<IType>>& params,
         bool proc);
     
-    std::shared_ptr<ProcBody> proc(const std::string& name);
-    std::shared_ptr<FuncBody> func(const std::string& name);
+    std::shared_ptr<ProcBody> proc(const attribute::Symbol& name);
+    std::shared_ptr<FuncBody> func(const attribute::Symbol& name);
 
     auto record() { return record_; }
     auto base() { return base_; }
@@ -1669,8 +1780,8 @@ private:
     void reachable_(
         std::vector<
             std::vector<std::shared_ptr<IDecl>>>& res,
-        std::vector<std::string>::const_iterator it,
-        std::vector<std::string>::const_iterator end,
+        attribute::QualifiedName::const_iterator it,
+        attribute::QualifiedName::const_iterator end,
         IDecl* requester) override {};
 
 private:
@@ -1679,7 +1790,7 @@ private:
     std::vector<std::weak_ptr<FuncBody>> funcs_;
 
     std::weak_ptr<ClassDecl> base_;
-    std::string name_;
+    attribute::Symbol name_;
 };
 
 class SuperclassReference : public IType {
@@ -1706,8 +1817,8 @@ private:
     void reachable_(
         std::vector<
             std::vector<std::shared_ptr<IDecl>>>& res,
-        std::vector<std::string>::const_iterator it,
-        std::vector<std::string>::const_iterator end,
+        attribute::QualifiedName::const_iterator it,
+        attribute::QualifiedName::const_iterator end,
         IDecl* requester) { assert(false); } 
 
 private:
@@ -0,0 +1,405 @@
+#include "peephole.hpp"
+
+#include "jvm_attribute.hpp"
+
+namespace peephole {
+
+// Code
+Code::Code(jvm_attribute::CodeAttr& code) :
+    codeAttr_(code)
+{
+    for (auto&& bb : codeAttr_.code_) {
+        std::vector<Item> items;
+        std::size_t brIdx = 0;
+        for (auto&& i : bb->instrs_) {
+            auto* target = i.isBranch() ?
+                bb->branches_[brIdx++] : nullptr;
+            items.push_back({std::move(i), target});
+        }
+        bb->instrs_.clear();
+        bb->branches_.clear();
+        bbs_.push_back(bb.get());
+        blocks_.push_back(std::move(items));
+    }
+}
+
+std::size_t Code::size() const noexcept {
+    return blocks_.size();
+}
+
+bb::BasicBlock* Code::basicBlock(std::size_t id) const {
+    return bbs_.at(id);
+}
+
+std::vector<Item>& Code::block(std::size_t id) {
+    return blocks_.at(id);
+}
+
+const std::vector<Item>& Code::block(std::size_t id) const {
+    return blocks_.at(id);
+}
+
+std::optional<std::size_t> Code::resolve(std::size_t id) const {
+    for (; id < blocks_.size(); ++id) {
+        if (!blocks_[id].empty()) {
+            return id;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<std::size_t> Code::next(std::size_t id) const {
+    if (!fallsThrough(id)) {
+        return std::nullopt;
+    }
+    return resolve(id + 1);
+}
+
+bool Code::fallsThrough(std::size_t id) const {
+    auto&& b = blocks_.at(id);
+    return b.empty() ||
+        !instr::breaksFlow(b.back().instr.opCode());
+}
+
+std::vector<std::size_t> Code::predsCount() const {
+    std::vector<std::size_t> preds(blocks_.size(), 0);
+    for (std::size_t id = 0; id < blocks_.size(); ++id) {
+        for (auto&& i : blocks_[id]) {
+            if (i.target) {
+                ++preds[i.target->id()];
+            }
+        }
+        if (fallsThrough(id) && id + 1 < blocks_.size()) {
+            ++preds[id + 1];
+        }
+    }
+    return preds;
+}
+
+void Code::commit() {
+    for (std::size_t id = 0; id < blocks_.size(); ++id) {
+        auto* bb = bbs_[id];
+        for (auto&& i : blocks_[id]) {
+            if (i.target) {
+                bb->branches_.push_back(i.target);
+            }
+            bb->instrs_.push_back(std::move(i.instr));
+        }
+    }
+    blocks_.clear();
+    bbs_.clear();
+    codeAttr_.layoutChanged_();
+}
+
+// Peephole
+void Peephole::addRule(SharedPtrRule rule) {
+    rules_.emplace_back(std::move(rule), 0);
+}
+
+void Peephole::run(jvm_attribute::CodeAttr& code) {
+    if (!enabled_) {
+        return;
+    }
+    static constexpr int maxRounds = 8;
+
+    Code c(code);
+    bool changed = true;
+    for (int round = 0; changed && round < maxRounds; ++round) {
+        changed = false;
+        for (auto&& [rule, hits] : rules_) {
+            auto n = rule->apply(c);
+            hits += n;
+            changed |= n > 0;
+        }
+    }
+    c.commit();
+}
+
+void Peephole::setEnabled(bool enabled) noexcept {
+    enabled_ = enabled;
+}
+
+bool Peephole::enabled() const noexcept {
+    return enabled_;
+}
+
+void Peephole::printStats(std::ostream& out) const {
+    out << "peephole:\n";
+    for (auto&& [rule, hits] : rules_) {
+        out << "  " << rule->name() << ": " << hits << '\n';
+    }
+}
+
+namespace {
+
+using instr::OpCode;
+
+bool isGoto(const Item& i) {
+    return OpCode::goto_ == i.instr.opCode();
+}
+
+Item makeItem(OpCode op, bb::BasicBlock* target = nullptr) {
+    return { instr::Instr(op, nullptr != target),
+             target };
+}
+
+// goto на bb, в который и так проваливается управление
+struct GotoNext : IPeepholeRule {
+    const std::string& name() const noexcept override {
+        static const std::string name("goto-next");
+        return name;
+    }
+
+    std::size_t apply(Code& code) override {
+        std::size_t hits = 0;
+        for (std::size_t id = 0; id < code.size(); ++id) {
+            auto&& b = code.block(id);
+            if (b.empty() || !isGoto(b.back())) {
+                continue;
+            }
+            auto to = code.resolve(b.back().target->id());
+            auto next = code.resolve(id + 1);
+            if (to && to == next) {
+                b.pop_back();
+                ++hits;
+            }
+        }
+        return hits;
+    }
+};
+
+// переход на bb из одного goto -> сразу на его цель
+struct JumpThreading : IPeepholeRule {
+    const std::string& name() const noexcept override {
+        static const std::string name("jump-threading");
+        return name;
+    }
+
+    std::size_t apply(Code& code) override {
+        std::size_t hits = 0;
+        for (std::size_t id = 0; id < code.size(); ++id) {
+            for (auto&& i : code.block(id)) {
+                if (!i.target) {
+                    continue;
+                }
+                auto to = code.resolve(i.target->id());
+                if (!to) {
+                    continue;
+                }
+                auto&& b = code.block(*to);
+                if (1 == b.size() && isGoto(b.front()) &&
+                    code.resolve(b.front().target->id()) != to)
+                {
+                    i.target = b.front().target;
+                    ++hits;
+                }
+            }
+        }
+        return hits;
+    }
+};
+
+// iconst_0/1; goto E  где E: ifeq/ifne X
+// (булев результат сравнения, тут же проверяемый в if/while)
+// -> goto сразу на ветку, выбранную константой
+struct ConstBranch : IPeepholeRule {
+    const std::string& name() const noexcept override {
+        static const std::string name("const-branch");
+        return name;
+    }
+
+    std::size_t apply(Code& code) override {
+        std::size_t hits = 0;
+        for (std::size_t id = 0; id < code.size(); ++id) {
+            auto&& b = code.block(id);
+            auto n = b.size();
+            if (n < 2 || !isGoto(b[n - 1])) {
+                continue;
+            }
+            auto constOp = b[n - 2].instr.opCode();
+            if (OpCode::iconst_0 != constOp &&
+                OpCode::iconst_1 != constOp)
+            {
+                continue;
+            }
+            auto e = code.resolve(b[n - 1].target->id());
+            if (!e || *e == id) {
+                continue;
+            }
+            auto&& cond = code.block(*e);
+            auto condOp = cond.front().instr.opCode();
+            if (OpCode::ifeq != condOp && OpCode::ifne != condOp) {
+                continue;
+            }
+
+            bool taken = (OpCode::ifne == condOp) ==
+                         (OpCode::iconst_1 == constOp);
+            bb::BasicBlock* dest = nullptr;
+            if (taken) {
+                dest = cond.front().target;
+            } else if (1 == cond.size()) {
+                if (auto next = code.next(*e)) {
+                    dest = code.basicBlock(*next);
+                }
+            } else if (isGoto(cond[1])) {
+                dest = cond[1].target;
+            }
+            if (!dest) {
+                continue;
+            }
+            b.erase(b.end() - 2, b.end());
+            b.push_back(makeItem(OpCode::goto_, dest));
+            ++hits;
+        }
+        return hits;
+    }
+};
+
+// dup; ifne P  где P: pop ... и в P ведет только этот переход
+// -> ifne P; iconst_0, pop из P удаляется
+// (короткое замыкание or: в P значение не нужно,
+//  а при проваливании оно известно)
+struct DupBranchPop : IPeepholeRule {
+    const std::string& name() const noexcept override {
+        static const std::string name("dup-branch-pop");
+        return name;
+    }
+
+    std::size_t apply(Code& code) override {
+        std::size_t hits = 0;
+        auto preds = code.predsCount();
+        for (std::size_t id = 0; id < code.size(); ++id) {
+            auto&& b = code.block(id);
+            for (std::size_t k = 0; k + 1 < b.size(); ++k) {
+                if (OpCode::dup != b[k].instr.opCode()) {
+                    continue;
+                }
+                auto op = b[k + 1].instr.opCode();
+                OpCode known;
+                if (OpCode::ifne == op) {
+                    known = OpCode::iconst_0;
+                } else if (OpCode::ifnonnull == op) {
+                    known = OpCode::aconst_null;
+                } else {
+                    continue;
+                }
+                std::size_t p = b[k + 1].target->id();
+                auto&& pb = code.block(p);
+                if (p == id || 1 != preds[p] || pb.empty() ||
+                    OpCode::pop != pb.front().instr.opCode())
+                {
+                    continue;
+                }
+                pb.erase(pb.begin());
+                b.erase(b.begin() + k);
+                b.insert(b.begin() + k + 1, makeItem(known));
+                ++hits;
+            }
+        }
+        return hits;
+    }
+};
+
+// xstore x; xload x -> dup; xstore x
+struct StoreLoad : IPeepholeRule {
+    const std::string& name() const noexcept override {
+        static const std::string name("store-load");
+        return name;
+    }
+
+    std::size_t apply(Code& code) override {
+        std::size_t hits = 0;
+        for (std::size_t id = 0; id < code.size(); ++id) {
+            auto&& b = code.block(id);
+            for (std::size_t k = 0; k + 1 < b.size(); ++k) {
+                auto&& st = b[k].instr;
+                auto&& ld = b[k + 1].instr;
+                if (!st.local() || st.local() != ld.local()) {
+                    continue;
+                }
+                auto dup = dupFor(st.opCode(), ld.opCode());
+                if (!dup) {
+                    continue;
+                }
+                b[k + 1] = std::move(b[k]);
+                b[k] = makeItem(*dup);
+                ++hits;
+            }
+        }
+        return hits;
+    }
+
+private:
+    static std::optional<OpCode> dupFor(OpCode st, OpCode ld) {
+        using O = OpCode;
+        if ((O::istore == st && O::iload == ld) ||
+            (O::fstore == st && O::fload == ld) ||
+            (O::astore == st && O::aload == ld))
+        {
+            return O::dup;
+        }
+        if ((O::lstore == st && O::lload == ld) ||
+            (O::dstore == st && O::dload == ld))
+        {
+            return O::dup2;
+        }
+        return std::nullopt;
+    }
+};
+
+// bb, недостижимые из входа, очищаются
+struct Unreachable : IPeepholeRule {
+    const std::string& name() const noexcept override {
+        static const std::string name("unreachable");
+        return name;
+    }
+
+    std::size_t apply(Code& code) override {
+        if (!code.size()) {
+            return 0;
+        }
+        std::vector<bool> reached(code.size(), false);
+        std::vector<std::size_t> work{0};
+        reached[0] = true;
+        auto visit = [&] (std::size_t id) {
+            if (!reached[id]) {
+                reached[id] = true;
+                work.push_back(id);
+            }
+        };
+        while (!work.empty()) {
+            auto id = work.back();
+            work.pop_back();
+            for (auto&& i : code.block(id)) {
+                if (i.target) {
+                    visit(i.target->id());
+                }
+            }
+            if (code.fallsThrough(id) && id + 1 < code.size()) {
+                visit(id + 1);
+            }
+        }
+
+        std::size_t hits = 0;
+        for (std::size_t id = 0; id < code.size(); ++id) {
+            if (!reached[id] && !code.block(id).empty()) {
+                code.block(id).clear();
+                ++hits;
+            }
+        }
+        return hits;
+    }
+};
+
+} // namespace
+
+void addDefaultRules(Peephole& peephole) {
+    peephole.addRule(std::make_shared<ConstBranch>());
+    peephole.addRule(std::make_shared<JumpThreading>());
+    peephole.addRule(std::make_shared<GotoNext>());
+    peephole.addRule(std::make_shared<DupBranchPop>());
+    peephole.addRule(std::make_shared<StoreLoad>());
+    peephole.addRule(std::make_shared<Unreachable>());
+}
+
+} // namespace peephole
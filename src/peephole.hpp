@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "basic_block.hpp"
+#include "instruction.hpp"
+
+namespace jvm_attribute {
+    class CodeAttr;
+}
+
+namespace peephole {
+
+// инструкция bb и цель перехода (nullptr, если не переход)
+struct Item {
+    instr::Instr instr;
+    bb::BasicBlock* target = nullptr;
+};
+
+// код метода в виде, удобном для переписывания:
+// bb в порядке раскладки, id bb == индекс
+class Code {
+public:
+    explicit Code(jvm_attribute::CodeAttr& code);
+
+public:
+    std::size_t size() const noexcept;
+    bb::BasicBlock* basicBlock(std::size_t id) const;
+    std::vector<Item>& block(std::size_t id);
+    const std::vector<Item>& block(std::size_t id) const;
+
+    // первый непустой bb, начиная с id
+    std::optional<std::size_t> resolve(std::size_t id) const;
+    // bb, в который проваливается управление из id
+    std::optional<std::size_t> next(std::size_t id) const;
+    bool fallsThrough(std::size_t id) const;
+    // число входящих дуг (переходы и проваливание)
+    std::vector<std::size_t> predsCount() const;
+
+    // записывает инструкции обратно в bb
+    void commit();
+
+private:
+    jvm_attribute::CodeAttr& codeAttr_;
+    std::vector<bb::BasicBlock*> bbs_;
+    std::vector<std::vector<Item>> blocks_;
+};
+
+struct IPeepholeRule {
+    virtual ~IPeepholeRule() = default;
+
+    virtual const std::string& name() const noexcept = 0;
+    // -> число срабатываний
+    virtual std::size_t apply(Code& code) = 0;
+};
+
+using SharedPtrRule = std::shared_ptr<IPeepholeRule>;
+
+class Peephole {
+public:
+    void addRule(SharedPtrRule rule);
+    void run(jvm_attribute::CodeAttr& code);
+
+    void setEnabled(bool enabled) noexcept;
+    bool enabled() const noexcept;
+
+    // счетчики срабатываний правил по всем методам
+    void printStats(std::ostream& out) const;
+
+private:
+    std::vector<std::pair<SharedPtrRule, std::size_t>> rules_;
+    bool enabled_ = true;
+};
+
+// стандартный набор правил
+void addDefaultRules(Peephole& peephole);
+
+} // namespace peephole
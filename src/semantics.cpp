@@ -1,23 +1,220 @@
 #include "semantics.hpp"
 
+#include "alloc_stats.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
 namespace semantics {
+
+namespace {
+
+// модуль идет после всех, кого он импортирует, а .adb - еще и после 
+// своего .ads; модули на цикле (если CircularImportCheck еще не 
+// отработал) - в последней волне
+std::vector<std::vector<std::size_t>> moduleWaves(
+    const std::vector<std::shared_ptr<mdl::Module>>& program)
+{
+    std::unordered_map<std::string, std::vector<std::size_t>> byName;
+    for (std::size_t i = 0; i < program.size(); ++i) {
+        byName[program[i]->name()].push_back(i);
+    }
+
+    std::vector<std::vector<std::size_t>> users(program.size());
+    std::vector<std::size_t> deps(program.size());
+    auto depend = [&] (std::size_t mod, std::size_t dep) {
+        if (mod != dep) {
+            users[dep].push_back(mod);
+            ++deps[mod];
+        }
+    };
+    for (std::size_t i = 0; i < program.size(); ++i) {
+        auto&& mod = program[i];
+        for (auto&& with : mod->with()) {
+            auto it = byName.find(with->name().toString('.'));
+            if (it != byName.end()) {
+                for (auto dep : it->second) {
+                    depend(i, dep);
+                }
+            }
+        }
+        if ("adb" == mod->fileExtension()) {
+            for (auto dep : byName[mod->name()]) {
+                if ("ads" == program[dep]->fileExtension()) {
+                    depend(i, dep);
+                }
+            }
+        }
+    }
+
+    std::vector<std::vector<std::size_t>> waves;
+    std::vector<std::size_t> cur;
+    for (std::size_t i = 0; i < program.size(); ++i) {
+        if (!deps[i]) {
+            cur.push_back(i);
+        }
+    }
+    std::size_t placed = 0;
+    while (!cur.empty()) {
+        placed += cur.size();
+        std::vector<std::size_t> next;
+        for (auto i : cur) {
+            for (auto u : users[i]) {
+                if (!--deps[u]) {
+                    next.push_back(u);
+                }
+            }
+        }
+        std::ranges::sort(next);
+        waves.push_back(std::move(cur));
+        cur = std::move(next);
+    }
+    if (placed < program.size()) {
+        auto&& last = waves.emplace_back();
+        for (std::size_t i = 0; i < program.size(); ++i) {
+            if (deps[i]) {
+                last.push_back(i);
+            }
+        }
+    }
+    return waves;
+}
+
+} // namespace
     
 void ADASementics::addPart(
-    semantics_part::SharedPtr part) 
+    semantics_part::SharedPtr part, std::string name) 
 {
-    if (head_.expired()) {
-        head_ = part;
-        return;
+    for (auto&& req : part->after()) {
+        if (!added_.contains(req)) {
+            throw std::logic_error(
+                "Semantic pass " + name + " must run after " + req);
+        }
+    }
+    for (std::size_t beg = 0, end; beg <= name.size(); beg = end + 1) {
+        end = std::min(name.find('+', beg), name.size());
+        added_.insert(name.substr(beg, end - beg));
     }
-    head_.lock()->setTail(part);
+    parts_.emplace_back(std::move(name), std::move(part));
+}
+
+void ADASementics::setJobs(unsigned jobs) noexcept {
+    jobs_ = std::max(1u, jobs);
 }
 
 std::pair<bool, std::string>
 ADASementics::analyse(
     const std::vector<std::shared_ptr<mdl::Module>>& program)
 {
-    auto msg = head_.lock()->analyse(program);
-    return {msg.empty(), msg};
+    using clock = std::chrono::steady_clock;
+
+    stats_.clear();
+    waves_.clear();
+    for (auto&& [name, part] : parts_) {
+        part->resetVisits();
+        auto alloc = alloc_stats::snapshot();
+        auto start = clock::now();
+
+        std::string msg;
+        auto modulePart = 
+            std::dynamic_pointer_cast<semantics_part::IModulePart>(part);
+        if (modulePart && jobs_ > 1) {
+            msg = analyseParallel_(*modulePart, program);
+        } else {
+            msg = part->analyse(program);
+        }
+
+        auto end = clock::now();
+        auto allocEnd = alloc_stats::snapshot();
+        stats_.push_back({
+            name,
+            end - start,
+            part->visits(),
+            allocEnd.count - alloc.count,
+            allocEnd.bytes - alloc.bytes});
+        if (!msg.empty()) {
+            return {false, msg};
+        }
+    }
+    return {true, ""};
+}
+
+std::string ADASementics::analyseParallel_(
+    semantics_part::IModulePart& part,
+    const std::vector<std::shared_ptr<mdl::Module>>& program)
+{
+    if (waves_.empty()) {
+        waves_ = moduleWaves(program);
+    }
+
+    std::vector<std::string> errs(program.size());
+    std::vector<std::exception_ptr> excs(program.size());
+    for (auto&& wave : waves_) {
+        std::vector<std::size_t> mods;
+        std::ranges::copy_if(wave, std::back_inserter(mods), 
+            [&] (auto i) { return i >= part.firstModule(); });
+        std::ranges::sort(mods);
+
+        std::atomic<std::size_t> next = 0;
+        auto worker = [&] {
+            for (auto k = next++; k < mods.size(); k = next++) {
+                auto i = mods[k];
+                try {
+                    errs[i] = part.analyseModule(program[i]);
+                } catch (...) {
+                    excs[i] = std::current_exception();
+                }
+            }
+        };
+        {
+            auto threads = std::min<std::size_t>(jobs_, mods.size());
+            std::vector<std::jthread> pool;
+            for (std::size_t t = 1; t < threads; ++t) {
+                pool.emplace_back(worker);
+            }
+            worker();
+        }
+
+        for (auto i : mods) {
+            if (excs[i]) {
+                std::rethrow_exception(excs[i]);
+            }
+            if (!errs[i].empty()) {
+                return errs[i];
+            }
+        }
+    }
+    return "";
+}
+
+const std::vector<ADASementics::PassStats>& 
+ADASementics::stats() const noexcept {
+    return stats_;
+}
+
+void ADASementics::printStats(std::ostream& out) const {
+    out << "semantics:\n";
+    PassStats total{"total"};
+    auto line = [&] (const PassStats& s) {
+        auto us = std::chrono::duration_cast<
+            std::chrono::microseconds>(s.time);
+        out << "  " << s.name << ": " << us.count() << " us, " 
+            << s.visits << " visits, " << s.allocs << " allocs, " 
+            << s.bytes << " bytes\n";
+    };
+    for (auto&& s : stats_) {
+        line(s);
+        total.time += s.time;
+        total.visits += s.visits;
+        total.allocs += s.allocs;
+        total.bytes += s.bytes;
+    }
+    line(total);
 }
 
-}
\ No newline at end of file
+} // namespace semantics
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <unordered_set>
 #include <vector>
 #include <utility>
 
@@ -8,14 +13,49 @@
 
 namespace semantics {
 
+// менеджер проходов: проходы идут по порядку добавления,
+// для каждого замеряются время, число узлов и аллокации.
+// При jobs > 1 IModulePart идут по модулям параллельно
 class ADASementics {
 public:
-    void addPart(semantics_part::SharedPtr part);
+    struct PassStats {
+        std::string name;
+        std::chrono::nanoseconds time{};
+        std::size_t visits = 0;
+        std::size_t allocs = 0;
+        std::size_t bytes = 0;
+    };
+
+public:
+    // name - имя для after() других проходов и статистики;
+    // у совмещенного обхода - имена проверок через '+'.
+    // Кидает logic_error, если нарушен порядок из part->after()
+    void addPart(semantics_part::SharedPtr part, std::string name);
+    // 1 - все проходы в одном потоке
+    void setJobs(unsigned jobs) noexcept;
     std::pair<bool, std::string> analyse(
         const std::vector<std::shared_ptr<mdl::Module>>& program);
 
+    // только выполненные проходы, включая упавший
+    const std::vector<PassStats>& stats() const noexcept;
+    void printStats(std::ostream& out) const;
+
+private:
+    // волны по графу with: модули волны не зависят друг от друга
+    // и от следующих волн; ошибка - как при последовательном проходе
+    // от первого по порядку в program упавшего модуля той волны,
+    // в которой ошибка нашлась, следующие волны не запускаются
+    std::string analyseParallel_(
+        semantics_part::IModulePart& part,
+        const std::vector<std::shared_ptr<mdl::Module>>& program);
+
 private:
-    semantics_part::WeakPtr head_;
+    std::vector<std::pair<std::string, semantics_part::SharedPtr>> parts_;
+    unsigned jobs_ = 1;
+    // номера модулей в program, считаются при первом параллельном проходе
+    std::vector<std::vector<std::size_t>> waves_;
+    std::vector<PassStats> stats_;
+    std::unordered_set<std::string> added_;
 };
 
-} // namespace semantics
\ No newline at end of file
+} // namespace semantics
@@ -1,8 +1,12 @@
 #include "semantics_part.hpp"
 
 #include <sstream>
+#include <cmath>
+#include <cstdint>
 #include <ranges>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <iterator>
 #include <algorithm>
 #include <tuple>
@@ -17,6 +21,7 @@ std::string EntryPointCheck::analyse(
         const std::vector<
                 std::shared_ptr<mdl::Module>>& program) 
 {   
+    visit();
     auto unit = program[1]->unit().lock();
     if (!std::dynamic_pointer_cast<node::ProcBody>(unit) ||
          std::dynamic_pointer_cast<node::FuncBody>(unit)) 
@@ -24,43 +29,45 @@ std::string EntryPointCheck::analyse(
         return program[1]->fileName()
                 + ": The entry point should be a procedure";
     }
-    return ISemanticsPart::analyseNext(program);
+    return "";
 }
 
 // ModuleNameCheck
-std::string ModuleNameCheck::analyse(
-        const std::vector<
-                std::shared_ptr<mdl::Module>>& program) 
+std::size_t ModuleNameCheck::firstModule() const {
+    return 2;
+}
+
+std::string ModuleNameCheck::analyseModule(
+        const std::shared_ptr<mdl::Module>& mod) 
 {   
-    for (auto&& mod : program | std::views::drop(2)) {
-        auto unit = mod->unit().lock();
-        if (unit->name() != mod->name()) {
-            std::stringstream ss;
-            ss << mod->fileName();
-            ss << ":";
-            ss << " The name of the compilation unit must"
-                  " be equal to the name of the code file: ";
-            ss << mod->name();
-            ss << " != ";
-            ss << unit->name();
-            return ss.str();
-        }
+    visit();
+    auto unit = mod->unit().lock();
+    if (unit->name() != mod->name()) {
+        std::stringstream ss;
+        ss << mod->fileName();
+        ss << ":";
+        ss << " The name of the compilation unit must"
+              " be equal to the name of the code file: ";
+        ss << mod->name();
+        ss << " != ";
+        ss << unit->name();
+        return ss.str();
+    }
 
-        bool packDecl = 
-            std::dynamic_pointer_cast<node::PackDecl>(unit) && 
-            !std::dynamic_pointer_cast<node::PackBody>(unit);
-        bool isAds = mod->fileExtension() == "ads";
-        if (isAds ^ packDecl) {
-            std::stringstream ss;
-            ss << mod->fileName();
-            ss << ":";
-            ss << "Files with the ads extension must" 
-                  " contain the package declaration";
-            return ss.str();
-        }
+    bool packDecl = 
+        std::dynamic_pointer_cast<node::PackDecl>(unit) && 
+        !std::dynamic_pointer_cast<node::PackBody>(unit);
+    bool isAds = mod->fileExtension() == "ads";
+    if (isAds ^ packDecl) {
+        std::stringstream ss;
+        ss << mod->fileName();
+        ss << ":";
+        ss << "Files with the ads extension must" 
+              " contain the package declaration";
+        return ss.str();
     }
 
-    return ISemanticsPart::analyseNext(program);
+    return "";
 }
 
 // OneLevelWithCheck 
@@ -69,6 +76,7 @@ std::string OneLevelWithCheck::analyse(
                 std::shared_ptr<mdl::Module>>& program) 
 {   
     for (auto&& mod : program | std::views::drop(1)) {
+        visit();
         for (auto&& with : mod->with()) {
             auto&& name = with->name();
             if (name.size() != 1 && 
@@ -83,7 +91,7 @@ std::string OneLevelWithCheck::analyse(
         }
     }
 
-    return ISemanticsPart::analyseNext(program);
+    return "";
 }
 
 // SelfImportCheck
@@ -92,6 +100,7 @@ std::string SelfImportCheck::analyse(
                 std::shared_ptr<mdl::Module>>& program) 
 {   
     for (auto&& mod : program | std::views::drop(1)) {
+        visit();
         for (auto&& with : mod->with()) {
             auto&& name = with->name();
             if (name.first() == mod->name()) {
@@ -104,7 +113,7 @@ std::string SelfImportCheck::analyse(
         }
     }
 
-    return ISemanticsPart::analyseNext(program);
+    return "";
 }
 
 // ExistingModuleImportCheck
@@ -118,6 +127,7 @@ std::string ExistingModuleImportCheck::analyse(
                    [] (auto&& mod) { return mod->name(); });
 
     for (auto&& mod : program | std::views::drop(1)) {
+        visit();
         for (auto&& with : mod->with()) {
             auto&& name = with->name().toString('.');
             if (!moduleNames.contains(name)) {
@@ -130,7 +140,7 @@ std::string ExistingModuleImportCheck::analyse(
         }
     }
 
-    return ISemanticsPart::analyseNext(program);
+    return "";
 }
 
 // GlobalSpaceCreation
@@ -155,6 +165,7 @@ std::string GlobalSpaceCreation::analyse(
         [] (auto&& mod) { return mod.second; });
 
     for (auto&& mod : program) {
+        visit();
         auto unit = mod->unit().lock();
         auto gp = 
             std::make_shared<node::GlobalSpace>(unit);
@@ -181,7 +192,7 @@ std::string GlobalSpaceCreation::analyse(
         }
     }
 
-    return ISemanticsPart::analyseNext(program);
+    return "";
 }
 
 std::pair<bool, std::shared_ptr<node::With>> 
@@ -271,13 +282,14 @@ std::string CircularImportCheck::analyse(
         return "There is a looped import in the program";
     }
 
-    return ISemanticsPart::analyseNext(program);
+    return "";
 }
 
 bool CircularImportCheck::checkSpace_(
     node::GlobalSpace* cur, 
     std::vector<std::shared_ptr<node::IDecl>>& onStack)
 {
+    visit();
     auto&& unit = cur->unit();
     auto it = std::find(onStack.begin(), onStack.end(), unit);
     if (it != onStack.end()) {
@@ -299,38 +311,15 @@ bool CircularImportCheck::checkSpace_(
 }
 
 // NameConflictCheck 
-std::string NameConflictCheck::analyse(
-    const std::vector<
-        std::shared_ptr<mdl::Module>>& program)
-{
-    for (auto&& mod : program | std::views::drop(1)) {
-        auto space = 
-                std::dynamic_pointer_cast<node::GlobalSpace>(mod->unit().lock());
-        if (space) {
-            auto res = analyseDecl_(space->unit());
-            if (!res.empty()) {
-                std::stringstream ss;
-                ss << mod->fileName();
-                ss << ":";
-                ss << res;
-                return ss.str();
-            }
-        } else {
-            throw std::logic_error(
-                "Internal error in semantic_part.cpp");
-        }
-    }
-
-    return ISemanticsPart::analyseNext(program);
-}
-std::string NameConflictCheck::analyseDecl_( 
-    std::shared_ptr<node::IDecl> decl)
+std::string NameConflictCheck::enter(
+    const std::shared_ptr<node::IDecl>& decl,
+    const std::vector<node::IDecl*>& path)
 {
     if (std::dynamic_pointer_cast<node::VarDecl>(decl) || 
         std::dynamic_pointer_cast<node::TypeAliasDecl>(decl))  
     { return ""; }
 
-    std::map<std::string, std::shared_ptr<node::IDecl>> nameNDecl;
+    std::unordered_map<attribute::Symbol, std::shared_ptr<node::IDecl>> nameNDecl;
     std::vector<std::shared_ptr<node::IDecl>> allDecls;
     if (auto proc = 
             std::dynamic_pointer_cast<node::ProcBody>(decl)) 
@@ -346,7 +335,7 @@ std::string NameConflictCheck::analyseDecl_(
                 std::dynamic_pointer_cast<node::RecordDecl>(decl)) 
         {
             auto beg = record->decls()->begin();
-            auto end = record->decls()->begin();
+            auto end = record->decls()->end();
             allDecls.insert(allDecls.end(), beg, end);
 
         } 
@@ -354,7 +343,7 @@ std::string NameConflictCheck::analyseDecl_(
                     std::dynamic_pointer_cast<node::PackDecl>(decl))
         {
             auto beg = pack->decls()->begin();
-            auto end = pack->decls()->begin();
+            auto end = pack->decls()->end();
             allDecls.insert(allDecls.end(), beg, end);
 
             if (auto priv = pack->privateDecls()) {
@@ -394,13 +383,6 @@ std::string NameConflictCheck::analyseDecl_(
         }
     }
 
-    for (auto&& d : allDecls) {
-        auto res = analyseDecl_(d);
-        if (!res.empty()) {
-            return res;
-        }
-    }
-
     return "";
 } 
 
@@ -414,6 +396,7 @@ std::string PackBodyNDeclLinking::analyse(
     }
 
     for (auto&& mod : program | std::views::drop(1)) {
+        visit();
         auto space = 
                 std::dynamic_pointer_cast<node::GlobalSpace>(mod->unit().lock());
         if (space) {
@@ -431,7 +414,7 @@ std::string PackBodyNDeclLinking::analyse(
         }
     }
 
-    return ISemanticsPart::analyseNext(program);
+    return "";
 }
 
 static void analysePackDecl(
@@ -492,6 +475,7 @@ static std::string analysePackBody(
 std::string PackBodyNDeclLinking::analyseContainer_(
     std::shared_ptr<node::IDecl> decl)
 {      
+    visit();
     std::shared_ptr<node::DeclArea> decls;
     if (auto proc = std::dynamic_pointer_cast<node::ProcBody>(decl)) {
         decls = proc->decls();
@@ -565,6 +549,7 @@ TypeNameToRealType::analyse(
             std::shared_ptr<mdl::Module>>& program)
 {
     for (auto&& mod : program | std::views::drop(1)) {
+        visit();
         auto unit = mod->unit().lock();
         auto space = 
                 std::dynamic_pointer_cast<node::GlobalSpace>(unit);
@@ -583,13 +568,14 @@ TypeNameToRealType::analyse(
                 "Internal error in semantic_part.cpp");
         }
     }
-    return ISemanticsPart::analyseNext(program);
+    return "";
 }
 
 std::string 
 TypeNameToRealType::analyseContainer_(
     std::shared_ptr<node::IDecl> decl)
 {   
+    visit();
     // std::shared_ptr<node::DeclArea> decls;
     std::vector<std::shared_ptr<node::IDecl>> decls;
     if (auto proc = 
@@ -660,6 +646,7 @@ std::string
 TypeNameToRealType::analyseDecl_(
     std::shared_ptr<node::IDecl> decl)
 {   
+    visit();
     std::shared_ptr<node::TypeAliasDecl> alias;
     std::shared_ptr<node::VarDecl> var;
     std::shared_ptr<node::TypeName> typeName;
@@ -792,6 +779,7 @@ TypeNameToRealType::analyseArrayType_(
     node::IDecl* space,
     std::shared_ptr<node::IDecl> parent)
 {
+    visit();
     auto type = atype->type();
     if (auto typeName = 
             std::dynamic_pointer_cast<node::TypeName>(type)) 
@@ -837,6 +825,7 @@ TypeNameToRealType::analyseRecord_(
     std::shared_ptr<node::RecordDecl> decl,
     std::shared_ptr<node::RecordDecl> derived)
 {
+    visit();
     if (!decl->isInherits()) return "";
     if (decl->isInherits() && !decl->base().expired()) return "";
 
@@ -897,6 +886,7 @@ std::pair<std::string, std::shared_ptr<node::IType>>
 TypeNameToRealType::analyseAttrType_(
     std::shared_ptr<node::IType> type) 
 {   
+    visit();
     if (auto typeName = 
             std::dynamic_pointer_cast<node::TypeName>(type)) 
     {
@@ -920,30 +910,14 @@ TypeNameToRealType::analyseAttrType_(
 }
 
 // InheritsVarNameConlflicCheck
-std::string
-InheritsVarNameConlflicCheck::analyse(
-    const std::vector<
-    std::shared_ptr<mdl::Module>>& program)
-{
-    for (auto&& mod : program | std::views::drop(1)) {
-        auto unit = mod->unit().lock();
-        auto space = 
-                std::dynamic_pointer_cast<node::GlobalSpace>(unit);
-        auto res = analyseContainer_(space->unit());
-        if (!res.empty()) {
-            std::stringstream ss;
-            ss << mod->fileName();
-            ss << ":";
-            ss << res;
-            return ss.str();
-        }
-    }
-    return ISemanticsPart::analyseNext(program);
+std::vector<std::string> InheritsVarNameConlflicCheck::after() const {
+    return {"TypeNameToRealType"};
 }
 
 std::string 
-InheritsVarNameConlflicCheck::analyseContainer_(
-    std::shared_ptr<node::IDecl> decl)
+InheritsVarNameConlflicCheck::enter(
+    const std::shared_ptr<node::IDecl>& decl,
+    const std::vector<node::IDecl*>& path)
 {
     std::vector<std::shared_ptr<node::IDecl>> decls;
     if (auto proc = 
@@ -964,7 +938,7 @@ InheritsVarNameConlflicCheck::analyseContainer_(
 
     for (auto&& d : decls) {
         if (auto rec = std::dynamic_pointer_cast<node::RecordDecl>(d)) {
-            std::set<std::string> allVars;
+            std::unordered_set<attribute::Symbol> allVars;
             auto curRec = rec;
             while (curRec) {
                 for (auto&& v : *(curRec->decls())) {
@@ -983,41 +957,20 @@ InheritsVarNameConlflicCheck::analyseContainer_(
                 curRec = curRec->base().lock();
             }
         }
-
-        auto res = analyseContainer_(d);
-        if (!res.empty()) {
-            return res;
-        }
     }
 
     return "";
 }
 
 // OverloadCheck
-std::string 
-OverloadCheck::analyse(
-    const std::vector<
-        std::shared_ptr<mdl::Module>>& program) 
-{
-    for (auto&& mod : program | std::views::drop(1)) {
-        auto unit = mod->unit().lock();
-        auto space = 
-                std::dynamic_pointer_cast<node::GlobalSpace>(unit);
-        auto res = analyseContainer_(space->unit());
-        if (!res.empty()) {
-            std::stringstream ss;
-            ss << mod->fileName();
-            ss << ":";
-            ss << res;
-            return ss.str();
-        }
-    }
-    return ISemanticsPart::analyseNext(program);
+std::vector<std::string> OverloadCheck::after() const {
+    return {"TypeNameToRealType"};
 }
 
 std::string 
-OverloadCheck::analyseContainer_(
-    std::shared_ptr<node::IDecl> decl)
+OverloadCheck::enter(
+    const std::shared_ptr<node::IDecl>& decl,
+    const std::vector<node::IDecl*>& path)
 {
     std::vector<std::shared_ptr<node::IDecl>> decls;
     if (auto proc = 
@@ -1036,7 +989,7 @@ OverloadCheck::analyseContainer_(
         return "";
     }
 
-    std::map<std::string, std::vector<std::shared_ptr<node::IDecl>>> nameNDecls;
+    std::map<attribute::Symbol, std::vector<std::shared_ptr<node::IDecl>>> nameNDecls;
     for (auto&& d : decls) {
         nameNDecls[d->name()].push_back(d);
     }
@@ -1074,7 +1027,11 @@ OverloadCheck::analyseContainer_(
                         }
                     }
                     if (eq) {
+                        // имена объемлющих подпрограмм и пакетов
                         std::stringstream ss;
+                        for (auto* p : path) {
+                            ss << p->name() << '.';
+                        }
                         ss << decl->name();
                         ss << " Not an overload, but a name conflict: ";
                         ss << proc1->name();
@@ -1085,46 +1042,17 @@ OverloadCheck::analyseContainer_(
         }
     }
 
-    for (auto&& d : decls) {
-        if (std::dynamic_pointer_cast<node::PackDecl>(d) || 
-            std::dynamic_pointer_cast<node::ProcBody>(d))
-        {
-            auto res = analyseContainer_(d);
-            if (!res.empty()) {
-                std::stringstream ss;
-                ss << decl->name();
-                ss << '.';
-                ss << res;
-                return ss.str();
-            }
-        }
-    }
-
     return "";
 }
 
 // SubprogrBodyNDeclLinking
-std::string SubprogBodyNDeclLinking::analyse(
-    const std::vector<std::shared_ptr<mdl::Module>>& program) 
-{
-    for (auto&& mod : program | std::views::drop(1)) {
-        auto unit = mod->unit().lock();
-        auto space = 
-                std::dynamic_pointer_cast<node::GlobalSpace>(unit);
-        auto res = analyseContainer_(space->unit());
-        if (!res.empty()) {
-            std::stringstream ss;
-            ss << mod->fileName();
-            ss << ":";
-            ss << res;
-            return ss.str();
-        }
-    }
-    return ISemanticsPart::analyseNext(program);
+std::vector<std::string> SubprogBodyNDeclLinking::after() const {
+    return {"PackBodyNDeclLinking", "TypeNameToRealType"};
 }
 
-std::string SubprogBodyNDeclLinking::analyseContainer_(
-    std::shared_ptr<node::IDecl> decl)
+std::string SubprogBodyNDeclLinking::enter(
+    const std::shared_ptr<node::IDecl>& decl,
+    const std::vector<node::IDecl*>& path)
 {
     bool isPackDecl = false;
     std::vector<std::shared_ptr<node::IDecl>> decls;
@@ -1141,7 +1069,7 @@ std::string SubprogBodyNDeclLinking::analyseContainer_(
         return "";
     }
 
-    std::map<std::string, std::vector<std::shared_ptr<node::IDecl>>> map;
+    std::unordered_map<attribute::Symbol, std::vector<std::shared_ptr<node::IDecl>>> map;
     if (isPackDecl) {
         if (auto body = pack->packBody().lock()) {
             for (auto&& d : *body->decls()) {
@@ -1220,21 +1148,21 @@ std::string SubprogBodyNDeclLinking::analyseContainer_(
                 return ss.str();
             }
         }
-
-        auto res = analyseContainer_(d);
-        if (!res.empty()) {
-            return res;
-        }
     }
 
     return "";
 }
 
 // CreateClassDeclaration
+std::vector<std::string> CreateClassDeclaration::after() const {
+    return {"SubprogBodyNDeclLinking"};
+}
+
 std::string CreateClassDeclaration::analyse(
     const std::vector<std::shared_ptr<mdl::Module>>& program) 
 {
     for (auto&& mod : program | std::views::drop(1)) {
+        visit();
         auto unit = mod->unit().lock();
         auto space = 
                 std::dynamic_pointer_cast<node::GlobalSpace>(unit);
@@ -1247,11 +1175,12 @@ std::string CreateClassDeclaration::analyse(
             return ss.str();
         }
     }
-    return ISemanticsPart::analyseNext(program);
+    return "";
 }
 
 std::string
 CreateClassDeclaration::analyseContainer_(node::IDecl* decl) {
+    visit();
     std::vector<std::shared_ptr<node::IDecl>> decls;
     std::shared_ptr<node::DeclArea> declArea;
     if (auto pack = dynamic_cast<node::PackDecl*>(decl)) {
@@ -1300,7 +1229,6 @@ CreateClassDeclaration::analyseContainer_(node::IDecl* decl) {
                 continue;
             }
             bool isProc = !std::dynamic_pointer_cast<node::FuncBody>(proc);    
-            auto name = proc->name();
             std::vector<std::shared_ptr<node::IType>> params;
             std::shared_ptr<node::ClassDecl> cls;
             for (auto var : proc->params()) {
@@ -1335,29 +1263,15 @@ CreateClassDeclaration::analyseContainer_(node::IDecl* decl) {
 }
 
 // OneClassInSubprogramCheckp
-std::string 
-OneClassInSubprogramCheck::analyse(
-    const std::vector<
-        std::shared_ptr<mdl::Module>>& program) 
-{
-    for (auto&& mod : program | std::views::drop(1)) {
-        auto unit = mod->unit().lock();
-        auto space = 
-                std::dynamic_pointer_cast<node::GlobalSpace>(unit);
-        auto res = analyseContainer_(space->unit());
-        if (!res.empty()) {
-            std::stringstream ss;
-            ss << mod->fileName();
-            ss << ":";
-            ss << res;
-            return ss.str();
-        }
-    }
-    return ISemanticsPart::analyseNext(program);
+std::vector<std::string> OneClassInSubprogramCheck::after() const {
+    return {"CreateClassDeclaration"};
 }
 
 std::string 
-OneClassInSubprogramCheck::analyseContainer_(std::shared_ptr<node::IDecl> decl) {
+OneClassInSubprogramCheck::enter(
+    const std::shared_ptr<node::IDecl>& decl,
+    const std::vector<node::IDecl*>& path)
+{
     std::vector<std::shared_ptr<node::IDecl>> decls;
     if (auto proc = 
             std::dynamic_pointer_cast<node::ProcBody>(decl)) 
@@ -1490,11 +1404,6 @@ OneClassInSubprogramCheck::analyseContainer_(std::shared_ptr<node::IDecl> decl)
                 }
             }
         }
-
-        auto res = analyseContainer_(d);
-        if (!res.empty()) {
-            return res;
-        }
     }
 
     return "";
@@ -1506,6 +1415,7 @@ std::string LinkExprs::analyse(
             std::shared_ptr<mdl::Module>>& program)     
 {
     for (auto&& mod : program | std::views::drop(1)) {
+        visit();
         auto unit = mod->unit().lock();
         auto space = 
                 std::dynamic_pointer_cast<node::GlobalSpace>(unit);
@@ -1518,7 +1428,7 @@ std::string LinkExprs::analyse(
             return ss.str();
         }
     }
-    return ISemanticsPart::analyseNext(program);
+    return "";
 }
 
 //  для assign:
@@ -1545,6 +1455,7 @@ std::string LinkExprs::analyse(
  * 4. Линковка выражений
 */
 std::string LinkExprs::analyseContainer_(std::shared_ptr<node::IDecl> decl) {
+    visit();
     std::vector<std::shared_ptr<node::VarDecl>> args;
     std::shared_ptr<node::Body> body;
     std::shared_ptr<node::DeclArea> decls;
@@ -1619,6 +1530,7 @@ std::string LinkExprs::analyseBody_(
     std::shared_ptr<node::DeclArea> parDecls,
     const std::vector<std::shared_ptr<node::VarDecl>>& args)
 {
+    visit();
     if (!body) {
         return "";
     }
@@ -1779,6 +1691,7 @@ std::string LinkExprs::analyseBody_(
 
 std::pair<std::string, std::shared_ptr<node::IExpr>> 
 LinkExprs::analyseOp_(std::shared_ptr<node::Op> op) {
+    visit();
     static attribute::QualifiedName name;
 
     auto getRes = [this](auto&& exprOrOP, auto&& qName) {
@@ -1867,6 +1780,7 @@ std::string LinkExprs::analyseRecord_(
     std::shared_ptr<node::DotOpExpr> left, 
     std::shared_ptr<node::IExpr> right)
 {
+    visit();
     if (auto dotOp = std::dynamic_pointer_cast<node::Op>(right)) {
         auto res = analyseRecord_(left, dotOp->left());
         if (!res.empty()) {
@@ -1883,7 +1797,7 @@ std::string LinkExprs::analyseRecord_(
     auto ref = std::dynamic_pointer_cast<node::SuperclassReference>(tail->type());
     auto record = ref ? ref->cls()->record() : 
         std::dynamic_pointer_cast<node::RecordDecl>(tail->type());
-    std::string name;
+    attribute::Symbol name;
     tail->setNoAnalyse();
     std::vector<std::shared_ptr<node::IExpr>> args({tail});
     if (auto nameExpr = std::dynamic_pointer_cast<node::NameExpr>(right)) {
@@ -1950,6 +1864,7 @@ LinkExprs::analyseExpr_(
     std::shared_ptr<node::IExpr> expr, 
     attribute::QualifiedName& base) 
 {
+    visit();
     node::IDecl* par = nullptr;
     std::vector<std::shared_ptr<node::IExpr>> args;
     node::IDecl* requester = nullptr;
@@ -2223,6 +2138,7 @@ std::string LinkExprs::analyseArgsExpr_(
     const std::vector<std::shared_ptr<node::VarDecl>>& argsP,
     std::shared_ptr<node::IExpr> expr) 
 {
+    visit();
     if (auto callOrIdx = 
             std::dynamic_pointer_cast<node::CallOrIdxExpr>(expr)) 
     {
@@ -2399,27 +2315,27 @@ std::string LinkExprs::analyseInOutRvalLvalNoVal_(
 }
 
 // TypeCheck
-std::string TypeCheck::analyse(
-        const std::vector<std::shared_ptr<mdl::Module>>& program)
+std::string TypeCheck::analyseModule(
+        const std::shared_ptr<mdl::Module>& mod)
 {
-    for (auto&& mod : program | std::views::drop(1)) {
-        auto unit = mod->unit().lock();
-        auto space = 
-                std::dynamic_pointer_cast<node::GlobalSpace>(unit);
-        auto res = analyseContainer_(space->unit());
-        if (!res.empty()) {
-            std::stringstream ss;
-            ss << mod->fileName();
-            ss << ":";
-            ss << res;
-            return ss.str();
-        }
+    visit();
+    auto unit = mod->unit().lock();
+    auto space = 
+            std::dynamic_pointer_cast<node::GlobalSpace>(unit);
+    auto res = analyseContainer_(space->unit());
+    if (!res.empty()) {
+        std::stringstream ss;
+        ss << mod->fileName();
+        ss << ":";
+        ss << res;
+        return ss.str();
     }
-    return ISemanticsPart::analyseNext(program);
+    return "";
 }
 
 std::string 
 TypeCheck::analyseContainer_(std::shared_ptr<node::IDecl> decl) {
+    visit();
     std::vector<std::shared_ptr<node::VarDecl>> args;
     std::shared_ptr<node::Body> body;
     std::shared_ptr<node::DeclArea> decls;
@@ -2467,6 +2383,7 @@ TypeCheck::analyseContainer_(std::shared_ptr<node::IDecl> decl) {
 
 std::string 
 TypeCheck::analyseBody_(std::shared_ptr<node::Body> body) {
+    visit();
     if (!body) {
         return "";
     }
@@ -2559,17 +2476,891 @@ TypeCheck::analyseBody_(std::shared_ptr<node::Body> body) {
     return  "";
 }
 
+// ConstantFolding
+namespace {
+
+using LiteralPtr = std::shared_ptr<node::SimpleLiteral>;
+
+template <class T>
+LiteralPtr makeLiteral(node::SimpleType type, T value) {
+    return std::make_shared<node::SimpleLiteral>(
+        std::make_shared<node::SimpleLiteralType>(type), value);
+}
+
+std::shared_ptr<node::StringLiteral> 
+makeStringLiteral(const std::string& str, bool inf) {
+    auto type = std::make_shared<node::StringType>(
+        std::make_pair(1, static_cast<int>(str.length())));
+    if (inf) {
+        type->setInf();
+    }
+    return std::make_shared<node::StringLiteral>(type, str);
+}
+
+template <class T>
+LiteralPtr foldCompare(node::OpType op, T l, T r) {
+    bool res;
+    switch (op) {
+        case node::OpType::EQ:   res = l == r; break;
+        case node::OpType::NEQ:  res = l != r; break;
+        case node::OpType::MORE: res = l > r;  break;
+        case node::OpType::LESS: res = l < r;  break;
+        case node::OpType::GTE:  res = l >= r; break;
+        case node::OpType::LTE:  res = l <= r; break;
+        default: return nullptr;
+    }
+    return makeLiteral(node::SimpleType::BOOL, res);
+}
+
+// как в JVM: переполнение по модулю 2^32,
+// деление на 0 оставляется до исполнения
+LiteralPtr foldInt(node::OpType op, std::int64_t l, std::int64_t r) {
+    std::int64_t res;
+    switch (op) {
+        case node::OpType::PLUS:   res = l + r; break;
+        case node::OpType::MINUS:  res = l - r; break;
+        case node::OpType::MUL:    res = l * r; break;
+        case node::OpType::UMINUS: res = -r;    break;
+        case node::OpType::DIV:
+            if (!r) {
+                return nullptr;
+            }
+            res = l / r;
+            break;
+        case node::OpType::MOD:
+            if (!r) {
+                return nullptr;
+            }
+            res = l % r;
+            break;
+        default: 
+            return foldCompare(op, l, r);
+    }
+    return makeLiteral(node::SimpleType::INTEGER, 
+                       static_cast<int>(static_cast<std::int32_t>(res)));
+}
+
+// fcmpl с NaN ведет себя не как операторы C++ - не сворачиваем
+LiteralPtr foldFloat(node::OpType op, float l, float r) {
+    float res;
+    switch (op) {
+        case node::OpType::PLUS:   res = l + r; break;
+        case node::OpType::MINUS:  res = l - r; break;
+        case node::OpType::MUL:    res = l * r; break;
+        case node::OpType::UMINUS: res = -r;    break;
+        case node::OpType::DIV:
+            if (0.0f == r) {
+                return nullptr;
+            }
+            res = l / r;
+            break;
+        case node::OpType::MOD:
+            if (0.0f == r) {
+                return nullptr;
+            }
+            res = std::fmod(l, r);
+            break;
+        default: 
+            if (std::isnan(l) || std::isnan(r)) {
+                return nullptr;
+            }
+            return foldCompare(op, l, r);
+    }
+    return makeLiteral(node::SimpleType::FLOAT, res);
+}
+
+LiteralPtr foldBool(node::OpType op, bool l, bool r) {
+    bool res;
+    switch (op) {
+        case node::OpType::AND: res = l && r; break;
+        case node::OpType::OR:  res = l || r; break;
+        case node::OpType::XOR: res = l != r; break;
+        case node::OpType::NOT: res = !r;     break;
+        default: 
+            return foldCompare(op, l, r);
+    }
+    return makeLiteral(node::SimpleType::BOOL, res);
+}
+
+} // namespace
+
+std::string ConstantFolding::analyse(
+        const std::vector<std::shared_ptr<mdl::Module>>& program)
+{
+    for (auto&& mod : program | std::views::drop(1)) {
+        visit();
+        auto unit = mod->unit().lock();
+        auto space = 
+                std::dynamic_pointer_cast<node::GlobalSpace>(unit);
+        analyseContainer_(space->unit());
+    }
+    return "";
+}
+
+void ConstantFolding::analyseContainer_(std::shared_ptr<node::IDecl> decl) {
+    visit();
+    std::vector<std::shared_ptr<node::DeclArea>> areas;
+    std::shared_ptr<node::Body> body;
+
+    if (auto proc = std::dynamic_pointer_cast<node::ProcBody>(decl)) {
+        areas.push_back(proc->decls());
+        body = proc->body();
+    } else if (auto pack = std::dynamic_pointer_cast<node::PackDecl>(decl)) {
+        areas.push_back(pack->decls());
+        areas.push_back(pack->privateDecls());
+    } else if (auto record = std::dynamic_pointer_cast<node::RecordDecl>(decl)) {
+        areas.push_back(record->decls());
+    } else {
+        return;
+    }
+
+    for (auto&& decls : areas) {
+        if (!decls) {
+            continue;
+        }
+        for (auto&& d : *decls) {
+            if (auto var = std::dynamic_pointer_cast<node::VarDecl>(d)) {
+                analyseVar_(var.get());
+            } else {
+                analyseContainer_(d);
+            }
+        }
+    }
+
+    analyseBody_(body);
+}
+
+void ConstantFolding::analyseBody_(std::shared_ptr<node::Body> body) {
+    visit();
+    if (!body) {
+        return;
+    }
+
+    for (auto&& stm : *body) {
+        if (auto if_ = std::dynamic_pointer_cast<node::If>(stm)) {
+            if_->setCond(fold_(if_->cond()));
+            analyseBody_(if_->body());
+            analyseBody_(if_->bodyElse());
+            for (auto&& [cond, body] : if_->elsifs()) {
+                cond = fold_(cond);
+                analyseBody_(body);
+            }
+        } else if (auto while_ = std::dynamic_pointer_cast<node::While>(stm)) {
+            while_->setCond(fold_(while_->cond()));
+            analyseBody_(while_->body());
+        } else if (auto for_ = std::dynamic_pointer_cast<node::For>(stm)) {
+            auto [expr1, expr2] = for_->range();
+            for_->setRange({fold_(expr1), fold_(expr2)});
+            analyseBody_(for_->body());
+        } else if (auto asg = std::dynamic_pointer_cast<node::Assign>(stm)) {
+            asg->setLval(fold_(asg->lval()));
+            asg->setRval(fold_(asg->rval()));
+        } else if (auto ret = std::dynamic_pointer_cast<node::Return>(stm)) {
+            if (ret->retVal()) {
+                ret->setRetVal(fold_(ret->retVal()));
+            }
+        } else if (auto call = std::dynamic_pointer_cast<node::MBCall>(stm)) {
+            call->setCall(fold_(call->call()));
+        }
+    }
+}
+
+void ConstantFolding::analyseVar_(node::VarDecl* var) {
+    visit();
+    // повторно не сворачиваем, и константа, 
+    // ссылающаяся сама на себя, не зациклит
+    if (!folded_.insert(var).second || !var->rval()) {
+        return;
+    }
+    var->setRval(fold_(var->rval()));
+}
+
+std::shared_ptr<node::IExpr> 
+ConstantFolding::fold_(std::shared_ptr<node::IExpr> expr) {
+    visit();
+    if (auto op = std::dynamic_pointer_cast<node::Op>(expr)) {
+        return foldOp_(op);
+    }
+    if (auto image = std::dynamic_pointer_cast<node::ImageCallExpr>(expr)) {
+        return foldImage_(image);
+    }
+
+    auto dotOp = std::dynamic_pointer_cast<node::DotOpExpr>(expr);
+    if (!dotOp) {
+        return expr;
+    }
+    // строковые константы не подставляются: 
+    // у константы и так один общий char[]
+    auto val = std::dynamic_pointer_cast<node::SimpleLiteral>(
+        constValue_(dotOp));
+    if (val) {
+        return std::make_shared<node::SimpleLiteral>(*val);
+    }
+
+    // индексы и аргументы по всей цепочке
+    for (auto part = dotOp; part; part = part->right()) {
+        std::vector<std::shared_ptr<node::IExpr>>* exprs = nullptr;
+        if (auto idx = std::dynamic_pointer_cast<node::GetArrElementExpr>(part)) {
+            exprs = &idx->idxs();
+        } else if (auto call = std::dynamic_pointer_cast<node::CallExpr>(part)) {
+            exprs = &call->params();
+        } else if (auto call = std::dynamic_pointer_cast<node::CallMethodExpr>(part)) {
+            exprs = &call->params();
+        }
+        if (!exprs) {
+            continue;
+        }
+        for (auto&& e : *exprs) {
+            // объект вызова метода - часть этой же цепочки
+            if (!e->noAnalyse()) {
+                e = fold_(e);
+            }
+        }
+    }
+    return expr;
+}
+
+std::shared_ptr<node::IExpr> 
+ConstantFolding::foldOp_(std::shared_ptr<node::Op> op) {
+    if (op->left()) {
+        op->setLeft(fold_(op->left()));
+    }
+    op->setRight(fold_(op->right()));
+
+    if (node::OpType::AMPER == op->op()) {
+        auto str = [this] (std::shared_ptr<node::IExpr> expr) {
+            if (auto lit = std::dynamic_pointer_cast<node::StringLiteral>(expr)) {
+                return lit;
+            }
+            return std::dynamic_pointer_cast<node::StringLiteral>(
+                constValue_(expr));
+        };
+        auto l = str(op->left());
+        auto r = str(op->right());
+        if (!l || !r) {
+            return op;
+        }
+        auto type = std::dynamic_pointer_cast<node::StringType>(op->type());
+        return makeStringLiteral(l->str() + r->str(), type && type->inf());
+    }
+
+    auto l = std::dynamic_pointer_cast<node::SimpleLiteral>(op->left());
+    auto r = std::dynamic_pointer_cast<node::SimpleLiteral>(op->right());
+    if (!r || (op->left() && !l) || 
+        (l && l->literalType() != r->literalType())) 
+    {
+        return op;
+    }
+
+    LiteralPtr res;
+    switch (r->literalType()) {
+        case node::SimpleType::INTEGER:
+            res = foldInt(op->op(), l ? l->get<int>() : 0, r->get<int>());
+            break;
+        case node::SimpleType::FLOAT:
+            res = foldFloat(op->op(), l ? l->get<float>() : 0.0f, r->get<float>());
+            break;
+        case node::SimpleType::BOOL:
+            res = foldBool(op->op(), l ? l->get<bool>() : false, r->get<bool>());
+            break;
+        case node::SimpleType::CHAR:
+            res = l ? foldCompare(op->op(), l->get<char>(), r->get<char>()) 
+                    : nullptr;
+            break;
+    }
+    if (res) {
+        return res;
+    }
+    return op;
+}
+
+std::shared_ptr<node::IExpr> 
+ConstantFolding::foldImage_(std::shared_ptr<node::ImageCallExpr> image) {
+    image->setParam(fold_(image->param()));
+    auto lit = std::dynamic_pointer_cast<node::SimpleLiteral>(image->param());
+    if (!lit || lit->literalType() != image->imageType()->type()) {
+        return image;
+    }
+
+    std::string str;
+    switch (lit->literalType()) {
+        case node::SimpleType::INTEGER:
+            str = std::to_string(lit->get<int>());
+            break;
+        case node::SimpleType::BOOL:
+            str = lit->get<bool>() ? "true" : "false";
+            break;
+        case node::SimpleType::CHAR:
+            str = std::string(1, lit->get<char>());
+            break;
+        case node::SimpleType::FLOAT:
+            // формат Float.toString повторять не беремся
+            return image;
+    }
+    return makeStringLiteral(str, true);
+}
+
+std::shared_ptr<node::ILiteral> 
+ConstantFolding::constValue_(std::shared_ptr<node::IExpr> expr) {
+    // только Var и Pack.Var, без полей рекордов и вызовов
+    auto part = std::dynamic_pointer_cast<node::DotOpExpr>(expr);
+    while (part && part->right()) {
+        if (!std::dynamic_pointer_cast<node::PackNamePart>(part)) {
+            return nullptr;
+        }
+        part = part->right();
+    }
+    auto getVar = std::dynamic_pointer_cast<node::GetVarExpr>(part);
+    if (!getVar || !getVar->var()->constant()) {
+        return nullptr;
+    }
+
+    auto var = getVar->var();
+    analyseVar_(var.get());
+    auto val = var->rval();
+    if (std::dynamic_pointer_cast<node::SimpleLiteral>(val) || 
+        std::dynamic_pointer_cast<node::StringLiteral>(val)) 
+    {
+        return std::static_pointer_cast<node::ILiteral>(val);
+    }
+    return nullptr;
+}
+
+// CopyElision
+std::string CopyElision::analyse(
+        const std::vector<std::shared_ptr<mdl::Module>>& program)
+{
+    for (auto&& mod : program | std::views::drop(1)) {
+        visit();
+        auto unit = mod->unit().lock();
+        auto space = 
+                std::dynamic_pointer_cast<node::GlobalSpace>(unit);
+        analyseContainer_(space->unit());
+    }
+    return "";
+}
+
+void CopyElision::analyseContainer_(std::shared_ptr<node::IDecl> decl) {
+    visit();
+    std::vector<std::shared_ptr<node::DeclArea>> areas;
+
+    if (auto proc = std::dynamic_pointer_cast<node::ProcBody>(decl)) {
+        for (auto&& d : *proc->decls()) {
+            if (!std::dynamic_pointer_cast<node::VarDecl>(d)) {
+                analyseContainer_(d);
+            }
+        }
+        analyseProc_(proc);
+        return;
+    } else if (auto pack = std::dynamic_pointer_cast<node::PackDecl>(decl)) {
+        areas.push_back(pack->decls());
+        areas.push_back(pack->privateDecls());
+    } else if (auto record = std::dynamic_pointer_cast<node::RecordDecl>(decl)) {
+        areas.push_back(record->decls());
+    } else {
+        return;
+    }
+
+    // поля и переменные пакета: только временные значения
+    for (auto&& decls : areas) {
+        if (!decls) {
+            continue;
+        }
+        for (auto&& d : *decls) {
+            if (auto var = std::dynamic_pointer_cast<node::VarDecl>(d)) {
+                if (var->rval() && fresh_(var->rval())) {
+                    var->rval()->setOwned();
+                }
+            } else {
+                analyseContainer_(d);
+            }
+        }
+    }
+}
+
+void CopyElision::analyseProc_(std::shared_ptr<node::ProcBody> proc) {
+    locals_.clear();
+    lastUse_.clear();
+    pos_.clear();
+    loops_.clear();
+    cur_ = 0;
+
+    std::vector<std::shared_ptr<node::VarDecl>> vars;
+    for (auto&& d : *proc->decls()) {
+        if (auto var = std::dynamic_pointer_cast<node::VarDecl>(d)) {
+            locals_.insert(var.get());
+            vars.push_back(var);
+        }
+    }
+
+    for (auto&& var : vars) {
+        pos_[var.get()] = ++cur_;
+        collectExpr_(var->rval());
+    }
+    collectBody_(proc->body());
+
+    for (auto&& var : vars) {
+        mark_(var->rval(), pos_[var.get()]);
+    }
+    markBody_(proc->body());
+}
+
+void CopyElision::collectBody_(std::shared_ptr<node::Body> body) {
+    visit();
+    if (!body) {
+        return;
+    }
+
+    auto loop = [this] (auto&& collect) {
+        loops_.emplace_back();
+        collect();
+        // конец цикла - отдельная позиция: последний 
+        // оператор тела не последнее использование
+        ++cur_;
+        auto used = std::move(loops_.back());
+        loops_.pop_back();
+        for (auto var : used) {
+            lastUse_[var] = cur_;
+            if (!loops_.empty()) {
+                loops_.back().insert(var);
+            }
+        }
+    };
+
+    for (auto&& stm : *body) {
+        pos_[stm.get()] = ++cur_;
+        if (auto if_ = std::dynamic_pointer_cast<node::If>(stm)) {
+            collectExpr_(if_->cond());
+            collectBody_(if_->body());
+            for (auto&& [cond, body] : if_->elsifs()) {
+                collectExpr_(cond);
+                collectBody_(body);
+            }
+            collectBody_(if_->bodyElse());
+        } else if (auto while_ = std::dynamic_pointer_cast<node::While>(stm)) {
+            loop([&] {
+                collectExpr_(while_->cond());
+                collectBody_(while_->body());
+            });
+        } else if (auto for_ = std::dynamic_pointer_cast<node::For>(stm)) {
+            auto [expr1, expr2] = for_->range();
+            collectExpr_(expr1);
+            collectExpr_(expr2);
+            loop([&] { collectBody_(for_->body()); });
+        } else if (auto asg = std::dynamic_pointer_cast<node::Assign>(stm)) {
+            collectExpr_(asg->lval());
+            collectExpr_(asg->rval());
+        } else if (auto ret = std::dynamic_pointer_cast<node::Return>(stm)) {
+            collectExpr_(ret->retVal());
+        } else if (auto call = std::dynamic_pointer_cast<node::MBCall>(stm)) {
+            collectExpr_(call->call());
+        }
+    }
+}
+
+void CopyElision::collectExpr_(std::shared_ptr<node::IExpr> expr) {
+    visit();
+    if (!expr) {
+        return;
+    }
+    if (auto op = std::dynamic_pointer_cast<node::Op>(expr)) {
+        collectExpr_(op->left());
+        collectExpr_(op->right());
+        return;
+    }
+    if (auto image = std::dynamic_pointer_cast<node::ImageCallExpr>(expr)) {
+        collectExpr_(image->param());
+        return;
+    }
+
+    auto dotOp = std::dynamic_pointer_cast<node::DotOpExpr>(expr);
+    for (auto part = dotOp; part; part = part->right()) {
+        std::vector<std::shared_ptr<node::IExpr>>* exprs = nullptr;
+        if (auto getVar = std::dynamic_pointer_cast<node::GetVarExpr>(part)) {
+            use_(getVar->var().get());
+        } else if (auto idx = std::dynamic_pointer_cast<node::GetArrElementExpr>(part)) {
+            use_(idx->arr().get());
+            exprs = &idx->idxs();
+        } else if (auto call = std::dynamic_pointer_cast<node::CallExpr>(part)) {
+            exprs = &call->params();
+        } else if (auto call = std::dynamic_pointer_cast<node::CallMethodExpr>(part)) {
+            exprs = &call->params();
+        }
+        if (exprs) {
+            for (auto&& e : *exprs) {
+                collectExpr_(e);
+            }
+        }
+    }
+}
+
+void CopyElision::use_(node::VarDecl* var) {
+    if (!locals_.contains(var)) {
+        return;
+    }
+    lastUse_[var] = cur_;
+    if (!loops_.empty()) {
+        loops_.back().insert(var);
+    }
+}
+
+void CopyElision::markBody_(std::shared_ptr<node::Body> body) {
+    visit();
+    if (!body) {
+        return;
+    }
+
+    for (auto&& stm : *body) {
+        if (auto if_ = std::dynamic_pointer_cast<node::If>(stm)) {
+            markBody_(if_->body());
+            for (auto&& [cond, body] : if_->elsifs()) {
+                markBody_(body);
+            }
+            markBody_(if_->bodyElse());
+        } else if (auto while_ = std::dynamic_pointer_cast<node::While>(stm)) {
+            markBody_(while_->body());
+        } else if (auto for_ = std::dynamic_pointer_cast<node::For>(stm)) {
+            markBody_(for_->body());
+        } else if (auto asg = std::dynamic_pointer_cast<node::Assign>(stm)) {
+            mark_(asg->rval(), pos_[asg.get()]);
+        } else if (auto ret = std::dynamic_pointer_cast<node::Return>(stm)) {
+            // после return локальные мертвы
+            auto val = ret->retVal();
+            if (val && (fresh_(val) || local_(val))) {
+                val->setOwned();
+            }
+        }
+    }
+}
+
+void CopyElision::mark_(std::shared_ptr<node::IExpr> expr, int pos) {
+    visit();
+    if (!expr) {
+        return;
+    }
+    if (fresh_(expr)) {
+        expr->setOwned();
+    } else if (auto var = local_(expr); var && lastUse_[var] == pos) {
+        expr->setOwned();
+    }
+}
+
+bool CopyElision::fresh_(std::shared_ptr<node::IExpr> expr) const {
+    // строковый литерал - общий static final массив, не fresh
+    if (std::dynamic_pointer_cast<node::ImageCallExpr>(expr)) {
+        return true;
+    }
+    if (auto op = std::dynamic_pointer_cast<node::Op>(expr)) {
+        return node::OpType::AMPER == op->op();
+    }
+    // результат функции: Return уже вернул копию
+    auto dotOp = std::dynamic_pointer_cast<node::DotOpExpr>(expr);
+    if (!dotOp) {
+        return false;
+    }
+    auto tail = dotOp->tail();
+    return std::dynamic_pointer_cast<node::CallExpr>(tail) || 
+           std::dynamic_pointer_cast<node::CallMethodExpr>(tail);
+}
+
+node::VarDecl* 
+CopyElision::local_(std::shared_ptr<node::IExpr> expr) const {
+    auto getVar = std::dynamic_pointer_cast<node::GetVarExpr>(expr);
+    if (!getVar || getVar->right()) {
+        return nullptr;
+    }
+    auto var = getVar->var().get();
+    return locals_.contains(var) ? var : nullptr;
+}
+
+// LoopIndexing
+std::string LoopIndexing::analyse(
+        const std::vector<std::shared_ptr<mdl::Module>>& program)
+{
+    for (auto&& mod : program | std::views::drop(1)) {
+        visit();
+        auto unit = mod->unit().lock();
+        auto space = 
+                std::dynamic_pointer_cast<node::GlobalSpace>(unit);
+        analyseContainer_(space->unit());
+    }
+    return "";
+}
+
+void LoopIndexing::analyseContainer_(std::shared_ptr<node::IDecl> decl) {
+    visit();
+    std::vector<std::shared_ptr<node::DeclArea>> areas;
+
+    if (auto proc = std::dynamic_pointer_cast<node::ProcBody>(decl)) {
+        locals_.clear();
+        for (auto&& d : *proc->decls()) {
+            if (auto var = std::dynamic_pointer_cast<node::VarDecl>(d)) {
+                locals_.insert(var.get());
+            } else {
+                analyseContainer_(d);
+            }
+        }
+        for (auto&& p : proc->params()) {
+            locals_.insert(p.get());
+        }
+        analyseBody_(proc->body());
+        return;
+    } else if (auto pack = std::dynamic_pointer_cast<node::PackDecl>(decl)) {
+        areas.push_back(pack->decls());
+        areas.push_back(pack->privateDecls());
+    } else if (auto record = std::dynamic_pointer_cast<node::RecordDecl>(decl)) {
+        areas.push_back(record->decls());
+    } else {
+        return;
+    }
+
+    for (auto&& decls : areas) {
+        if (!decls) {
+            continue;
+        }
+        for (auto&& d : *decls) {
+            if (!std::dynamic_pointer_cast<node::VarDecl>(d)) {
+                analyseContainer_(d);
+            }
+        }
+    }
+}
+
+void LoopIndexing::analyseBody_(std::shared_ptr<node::Body> body) {
+    visit();
+    if (!body) {
+        return;
+    }
+
+    for (auto&& stm : *body) {
+        if (auto if_ = std::dynamic_pointer_cast<node::If>(stm)) {
+            analyseBody_(if_->body());
+            for (auto&& [cond, body] : if_->elsifs()) {
+                analyseBody_(body);
+            }
+            analyseBody_(if_->bodyElse());
+        } else if (auto while_ = std::dynamic_pointer_cast<node::While>(stm)) {
+            analyseBody_(while_->body());
+        } else if (auto for_ = std::dynamic_pointer_cast<node::For>(stm)) {
+            // итератор внешнего цикла во вложенном не меняется
+            auto iter = for_->iter().get();
+            locals_.insert(iter);
+            assigned_.clear();
+            assigned_.insert(iter);
+            collectBody_(for_->body());
+            hoistBody_(for_, for_->body());
+            analyseBody_(for_->body());
+        }
+    }
+}
+
+void LoopIndexing::collectBody_(std::shared_ptr<node::Body> body) {
+    visit();
+    if (!body) {
+        return;
+    }
+
+    for (auto&& stm : *body) {
+        if (auto if_ = std::dynamic_pointer_cast<node::If>(stm)) {
+            collectExpr_(if_->cond());
+            collectBody_(if_->body());
+            for (auto&& [cond, body] : if_->elsifs()) {
+                collectExpr_(cond);
+                collectBody_(body);
+            }
+            collectBody_(if_->bodyElse());
+        } else if (auto while_ = std::dynamic_pointer_cast<node::While>(stm)) {
+            collectExpr_(while_->cond());
+            collectBody_(while_->body());
+        } else if (auto for_ = std::dynamic_pointer_cast<node::For>(stm)) {
+            auto [expr1, expr2] = for_->range();
+            collectExpr_(expr1);
+            collectExpr_(expr2);
+            collectBody_(for_->body());
+        } else if (auto asg = std::dynamic_pointer_cast<node::Assign>(stm)) {
+            if (auto getVar = std::dynamic_pointer_cast<node::GetVarExpr>(asg->lval())) {
+                assigned_.insert(getVar->var().get());
+            }
+            collectExpr_(asg->lval());
+            collectExpr_(asg->rval());
+        } else if (auto ret = std::dynamic_pointer_cast<node::Return>(stm)) {
+            collectExpr_(ret->retVal());
+        } else if (auto call = std::dynamic_pointer_cast<node::MBCall>(stm)) {
+            collectExpr_(call->call());
+        }
+    }
+}
+
+void LoopIndexing::collectExpr_(std::shared_ptr<node::IExpr> expr) {
+    visit();
+    if (!expr) {
+        return;
+    }
+    if (auto op = std::dynamic_pointer_cast<node::Op>(expr)) {
+        collectExpr_(op->left());
+        collectExpr_(op->right());
+        return;
+    }
+    if (auto image = std::dynamic_pointer_cast<node::ImageCallExpr>(expr)) {
+        collectExpr_(image->param());
+        return;
+    }
+
+    auto dotOp = std::dynamic_pointer_cast<node::DotOpExpr>(expr);
+    for (auto part = dotOp; part; part = part->right()) {
+        std::vector<std::shared_ptr<node::IExpr>>* exprs = nullptr;
+        bool call = false;
+        if (auto idx = std::dynamic_pointer_cast<node::GetArrElementExpr>(part)) {
+            exprs = &idx->idxs();
+        } else if (auto c = std::dynamic_pointer_cast<node::CallExpr>(part)) {
+            exprs = &c->params();
+            call = true;
+        } else if (auto c = std::dynamic_pointer_cast<node::CallMethodExpr>(part)) {
+            exprs = &c->params();
+            call = true;
+        }
+        if (!exprs) {
+            continue;
+        }
+        for (auto&& e : *exprs) {
+            // out параметр: переменная-аргумент может измениться
+            auto getVar = std::dynamic_pointer_cast<node::GetVarExpr>(e);
+            if (call && getVar) {
+                assigned_.insert(getVar->var().get());
+            }
+            collectExpr_(e);
+        }
+    }
+}
+
+void LoopIndexing::hoistBody_(
+    std::shared_ptr<node::For> loop, 
+    std::shared_ptr<node::Body> body)
+{
+    visit();
+    if (!body) {
+        return;
+    }
+
+    for (auto&& stm : *body) {
+        if (auto if_ = std::dynamic_pointer_cast<node::If>(stm)) {
+            hoistExpr_(loop, if_->cond());
+            hoistBody_(loop, if_->body());
+            for (auto&& [cond, body] : if_->elsifs()) {
+                hoistExpr_(loop, cond);
+                hoistBody_(loop, body);
+            }
+            hoistBody_(loop, if_->bodyElse());
+        } else if (auto while_ = std::dynamic_pointer_cast<node::While>(stm)) {
+            hoistExpr_(loop, while_->cond());
+            hoistBody_(loop, while_->body());
+        } else if (auto for_ = std::dynamic_pointer_cast<node::For>(stm)) {
+            auto [expr1, expr2] = for_->range();
+            hoistExpr_(loop, expr1);
+            hoistExpr_(loop, expr2);
+        } else if (auto asg = std::dynamic_pointer_cast<node::Assign>(stm)) {
+            hoistExpr_(loop, asg->lval());
+            hoistExpr_(loop, asg->rval());
+        } else if (auto ret = std::dynamic_pointer_cast<node::Return>(stm)) {
+            hoistExpr_(loop, ret->retVal());
+        } else if (auto call = std::dynamic_pointer_cast<node::MBCall>(stm)) {
+            hoistExpr_(loop, call->call());
+        }
+    }
+}
+
+void LoopIndexing::hoistExpr_(
+    std::shared_ptr<node::For> loop, 
+    std::shared_ptr<node::IExpr> expr)
+{
+    visit();
+    if (!expr) {
+        return;
+    }
+    if (auto op = std::dynamic_pointer_cast<node::Op>(expr)) {
+        hoistExpr_(loop, op->left());
+        hoistExpr_(loop, op->right());
+        return;
+    }
+    if (auto image = std::dynamic_pointer_cast<node::ImageCallExpr>(expr)) {
+        hoistExpr_(loop, image->param());
+        return;
+    }
+
+    auto dotOp = std::dynamic_pointer_cast<node::DotOpExpr>(expr);
+    for (auto part = dotOp; part; part = part->right()) {
+        std::vector<std::shared_ptr<node::IExpr>>* exprs = nullptr;
+        if (auto idx = std::dynamic_pointer_cast<node::GetArrElementExpr>(part)) {
+            exprs = &idx->idxs();
+            auto arrTy = std::dynamic_pointer_cast<node::ArrayType>(
+                idx->arr()->type());
+            std::size_t iterIdx = exprs->size();
+            bool ok = arrTy && 1 < exprs->size();
+            for (std::size_t i = 0; ok && i < exprs->size(); ++i) {
+                auto getVar = std::dynamic_pointer_cast<node::GetVarExpr>((*exprs)[i]);
+                if (getVar && !getVar->right() && getVar->var() == loop->iter()) {
+                    ok = iterIdx == exprs->size();
+                    iterIdx = i;
+                } else {
+                    ok = invariant_((*exprs)[i]);
+                }
+            }
+            if (ok && iterIdx != exprs->size()) {
+                idx->setLoopIdx(iterIdx);
+                loop->hoist(idx);
+            }
+        } else if (auto call = std::dynamic_pointer_cast<node::CallExpr>(part)) {
+            exprs = &call->params();
+        } else if (auto call = std::dynamic_pointer_cast<node::CallMethodExpr>(part)) {
+            exprs = &call->params();
+        }
+        if (exprs) {
+            for (auto&& e : *exprs) {
+                hoistExpr_(loop, e);
+            }
+        }
+    }
+}
+
+// вычисление до цикла не меняет поведения: без вызовов,
+// деления и чтений того, что тело может изменить
+bool LoopIndexing::invariant_(std::shared_ptr<node::IExpr> expr) const {
+    if (std::dynamic_pointer_cast<node::SimpleLiteral>(expr)) {
+        return true;
+    }
+    if (auto op = std::dynamic_pointer_cast<node::Op>(expr)) {
+        switch (op->op()) {
+            case node::OpType::PLUS:
+            case node::OpType::MINUS:
+            case node::OpType::MUL:
+                return invariant_(op->left()) && invariant_(op->right());
+            case node::OpType::UMINUS:
+                return invariant_(op->right());
+            default:
+                return false;
+        }
+    }
+    auto getVar = std::dynamic_pointer_cast<node::GetVarExpr>(expr);
+    if (!getVar || getVar->right()) {
+        return false;
+    }
+    auto var = getVar->var().get();
+    return locals_.contains(var) && !assigned_.contains(var) &&
+           std::dynamic_pointer_cast<node::SimpleLiteralType>(var->type());
+}
+
 // QualifiedNameSet
 std::string QualifiedNameSet::analyse(
         const std::vector<std::shared_ptr<mdl::Module>>& program)
 {
     for (auto&& mod : program | std::views::drop(1)) {
+        visit();
         auto unit = mod->unit().lock();
         auto space = 
                 std::dynamic_pointer_cast<node::GlobalSpace>(unit);
         analyseContainer_(space->unit(), mod->name());
     }
-    return ISemanticsPart::analyseNext(program);
+    return "";
 }
 
 
@@ -2577,6 +3368,7 @@ void QualifiedNameSet::analyseContainer_(
     std::shared_ptr<node::IDecl> decl, 
     attribute::QualifiedName name) 
 {
+    visit();
     name.push(decl->name());
     decl->setFullName(name);
     std::shared_ptr<node::DeclArea> decls;
@@ -1,8 +1,12 @@
 #pragma once
 
 #include "isemantics_part.hpp"
+#include "decl_walk.hpp"
 
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace semantics_part {
 
@@ -13,11 +17,11 @@ public:
                 std::shared_ptr<mdl::Module>>& program) override;
 };
 
-class ModuleNameCheck : public ISemanticsPart { 
+class ModuleNameCheck : public IModulePart { 
 public:
-    std::string analyse(
-            const std::vector<
-                std::shared_ptr<mdl::Module>>& program) override;
+    std::size_t firstModule() const override;
+    std::string analyseModule(
+            const std::shared_ptr<mdl::Module>& mod) override;
 };
 
 class OneLevelWithCheck : public ISemanticsPart { 
@@ -67,14 +71,13 @@ private:
         std::vector<std::shared_ptr<node::IDecl>>& onStack);
 };
 
-class NameConflictCheck : public ISemanticsPart { 
-public:
-    std::string analyse(
-            const std::vector<
-                std::shared_ptr<mdl::Module>>& program) override;
+// проверки, идущие в DeclWalk
 
+class NameConflictCheck : public IDeclCheck { 
 public:
-    std::string analyseDecl_(std::shared_ptr<node::IDecl> decl);
+    std::string enter(
+        const std::shared_ptr<node::IDecl>& decl,
+        const std::vector<node::IDecl*>& path) override;
 };
 
 class PackBodyNDeclLinking : public ISemanticsPart {
@@ -110,40 +113,38 @@ private:
     analyseAttrType_(std::shared_ptr<node::IType> type);  
 };
 
-class InheritsVarNameConlflicCheck : public ISemanticsPart {
+// база рекорда берется из TypeNameToRealType
+class InheritsVarNameConlflicCheck : public IDeclCheck {
 public:
-    std::string analyse(
-            const std::vector<
-                std::shared_ptr<mdl::Module>>& program) override;
-
-private:
-    std::string analyseContainer_(std::shared_ptr<node::IDecl> decl);
+    std::vector<std::string> after() const override;
+    std::string enter(
+        const std::shared_ptr<node::IDecl>& decl,
+        const std::vector<node::IDecl*>& path) override;
 };
 
-class OverloadCheck : public ISemanticsPart {
+// сравнивает типы параметров
+class OverloadCheck : public IDeclCheck {
 public:
-    std::string analyse(
-            const std::vector<
-                std::shared_ptr<mdl::Module>>& program) override;
-
-private:
-    std::string analyseContainer_(std::shared_ptr<node::IDecl> decl);
+    std::vector<std::string> after() const override;
+    std::string enter(
+        const std::shared_ptr<node::IDecl>& decl,
+        const std::vector<node::IDecl*>& path) override;
 };
 
-class SubprogBodyNDeclLinking : public ISemanticsPart {
-public:
+// нужны боди пакетов и типы параметров
+class SubprogBodyNDeclLinking : public IDeclCheck {
 public:
-    std::string analyse(
-            const std::vector<
-                std::shared_ptr<mdl::Module>>& program) override;
-
-private:
-    std::string analyseContainer_(std::shared_ptr<node::IDecl> decl);
-
+    std::vector<std::string> after() const override;
+    std::string enter(
+        const std::shared_ptr<node::IDecl>& decl,
+        const std::vector<node::IDecl*>& path) override;
 };
 
+// методы классов ищутся через ProcDecl -> боди
 class CreateClassDeclaration : public ISemanticsPart {
 public:
+    std::vector<std::string> after() const override;
+
     std::string analyse(
             const std::vector<
                 std::shared_ptr<mdl::Module>>& program) override;
@@ -152,14 +153,13 @@ private:
     std::string analyseContainer_(node::IDecl* decl);
 };
 
-class OneClassInSubprogramCheck : public ISemanticsPart {
+// классы рекордов создает CreateClassDeclaration
+class OneClassInSubprogramCheck : public IDeclCheck {
 public:
-    std::string analyse(
-            const std::vector<
-                std::shared_ptr<mdl::Module>>& program) override;
-
-private:
-    std::string analyseContainer_(std::shared_ptr<node::IDecl> decl);
+    std::vector<std::string> after() const override;
+    std::string enter(
+        const std::shared_ptr<node::IDecl>& decl,
+        const std::vector<node::IDecl*>& path) override;
 };
 
 class SetClassForRefs : public ISemanticsPart {
@@ -218,18 +218,115 @@ private:
 // op: равные типы у left и right
 // for: типы у и l ренджа - Integer
 // if и elsifs: тип выражения - Boolean
-class TypeCheck : public ISemanticsPart {
+class TypeCheck : public IModulePart {
+public:
+    std::string analyseModule(
+            const std::shared_ptr<mdl::Module>& mod) override;
+
+private:
+    std::string analyseContainer_(std::shared_ptr<node::IDecl> decl);
+
+    std::string analyseBody_(std::shared_ptr<node::Body> body); 
+};
+
+// после TypeCheck: op над литералами -> литерал,
+// чтения constant простых типов -> их значение,
+// 'image литерала и & строковых литералов -> строковый литерал
+class ConstantFolding : public ISemanticsPart {
 public:
     std::string analyse(
             const std::vector<
                 std::shared_ptr<mdl::Module>>& program) override;
 
 private:
-    std::string analyseContainer_(std::shared_ptr<node::IDecl> decl);
+    void analyseContainer_(std::shared_ptr<node::IDecl> decl);
+    void analyseBody_(std::shared_ptr<node::Body> body);
+    void analyseVar_(node::VarDecl* var);
 
-    std::string analyseBody_(std::shared_ptr<node::Body> body); 
+    [[nodiscard]] std::shared_ptr<node::IExpr> 
+    fold_(std::shared_ptr<node::IExpr> expr);
+    [[nodiscard]] std::shared_ptr<node::IExpr> 
+    foldOp_(std::shared_ptr<node::Op> op);
+    [[nodiscard]] std::shared_ptr<node::IExpr> 
+    foldImage_(std::shared_ptr<node::ImageCallExpr> image);
+
+    // значение constant, если expr - чтение свернутой константы
+    std::shared_ptr<node::ILiteral> 
+    constValue_(std::shared_ptr<node::IExpr> expr);
+
+private:
+    std::set<node::VarDecl*> folded_;
+};
+
+// после ConstantFolding: помечает owned значения присваиваний,
+// инициализаций и return, которые можно забрать без глубокой копии:
+// результат функции, & и 'image, а также локальная
+// переменная подпрограммы, которая дальше не используется
+// (в return - любая локальная)
+class CopyElision : public ISemanticsPart {
+public:
+    std::string analyse(
+            const std::vector<
+                std::shared_ptr<mdl::Module>>& program) override;
+
+private:
+    void analyseContainer_(std::shared_ptr<node::IDecl> decl);
+    void analyseProc_(std::shared_ptr<node::ProcBody> proc);
+
+    // нумерация операторов и последние использования локальных;
+    // использование в цикле длится до конца цикла
+    void collectBody_(std::shared_ptr<node::Body> body);
+    void collectExpr_(std::shared_ptr<node::IExpr> expr);
+    void use_(node::VarDecl* var);
+
+    void markBody_(std::shared_ptr<node::Body> body);
+    void mark_(std::shared_ptr<node::IExpr> expr, int pos);
+
+    bool fresh_(std::shared_ptr<node::IExpr> expr) const;
+    node::VarDecl* local_(std::shared_ptr<node::IExpr> expr) const;
+
+private:
+    std::unordered_set<node::VarDecl*> locals_;
+    std::unordered_map<node::VarDecl*, int> lastUse_;
+    std::unordered_map<const node::INode*, int> pos_;
+    // локальные, использованные в каждом из открытых циклов
+    std::vector<std::unordered_set<node::VarDecl*>> loops_;
+    int cur_ = 0;
 };
 
+// в теле For ищет обращения к N-мерным массивам, где один индекс - 
+// итератор цикла, а остальные - литералы и локальные, не меняющиеся
+// в теле (+, -, * над ними); их часть плоского индекса вместе с 
+// нижними границами вычисляется один раз до цикла (For::hoist)
+class LoopIndexing : public ISemanticsPart {
+public:
+    std::string analyse(
+            const std::vector<
+                std::shared_ptr<mdl::Module>>& program) override;
+
+private:
+    void analyseContainer_(std::shared_ptr<node::IDecl> decl);
+    void analyseBody_(std::shared_ptr<node::Body> body);
+
+    // переменные, которые тело цикла может изменить: 
+    // левые части присваиваний и аргументы вызовов
+    void collectBody_(std::shared_ptr<node::Body> body);
+    void collectExpr_(std::shared_ptr<node::IExpr> expr);
+
+    // вложенные For обрабатываются отдельно
+    void hoistBody_(
+        std::shared_ptr<node::For> loop, 
+        std::shared_ptr<node::Body> body);
+    void hoistExpr_(
+        std::shared_ptr<node::For> loop, 
+        std::shared_ptr<node::IExpr> expr);
+
+    bool invariant_(std::shared_ptr<node::IExpr> expr) const;
+
+private:
+    std::unordered_set<node::VarDecl*> locals_;
+    std::unordered_set<node::VarDecl*> assigned_;
+};
 
 class QualifiedNameSet : public ISemanticsPart {
 public:
@@ -0,0 +1,164 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "jar_writer.hpp"
+
+// обратный разбор потока deflate: только фиксированные коды,
+// других jar::deflate не пишет
+class Inflater {
+public:
+    explicit Inflater(const std::vector<std::byte>& in) : in_(in) {}
+
+    std::vector<std::byte> run() {
+        if (1 != bits_(1) || 1 != bits_(2)) {
+            throw std::runtime_error("expected one final fixed block");
+        }
+        std::vector<std::byte> out;
+        for (;;) {
+            auto sym = litLen_();
+            if (sym < 256) {
+                out.push_back(std::byte(sym));
+                continue;
+            }
+            if (256 == sym) {
+                return out;
+            }
+            static const std::uint16_t lenBase[] = {
+                3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+            static const std::uint8_t lenExtra[] = {
+                0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+            auto l = sym - 257;
+            std::size_t len = lenBase[l] + bits_(lenExtra[l]);
+            auto d = code_(5);
+            std::size_t dist = d < 4 ? d + 1 
+                : ((2 + (d & 1)) << ((d - 2) / 2)) + 1 + bits_((d - 2) / 2);
+            if (dist > out.size()) {
+                throw std::runtime_error("distance too far back");
+            }
+            for (std::size_t k = 0; k < len; ++k) {
+                out.push_back(out[out.size() - dist]);
+            }
+        }
+    }
+
+private:
+    std::uint32_t bits_(int n) {
+        std::uint32_t v = 0;
+        for (int i = 0; i < n; ++i, ++pos_) {
+            if (pos_ / 8 >= in_.size()) {
+                throw std::runtime_error("unexpected end of stream");
+            }
+            auto bit = (std::uint32_t(in_[pos_ / 8]) >> (pos_ % 8)) & 1;
+            v |= bit << i;
+        }
+        return v;
+    }
+
+    // код Хаффмана - со старшего бита
+    std::uint32_t code_(int n) {
+        std::uint32_t v = 0;
+        for (int i = 0; i < n; ++i) {
+            v = (v << 1) | bits_(1);
+        }
+        return v;
+    }
+
+    // RFC 1951, 3.2.6
+    std::uint32_t litLen_() {
+        auto v = code_(7);
+        if (v <= 0x17) {
+            return v + 256;
+        }
+        v = (v << 1) | bits_(1);
+        if (0x30 <= v && v <= 0xbf) {
+            return v - 0x30;
+        }
+        if (0xc0 <= v && v <= 0xc7) {
+            return v - 0xc0 + 280;
+        }
+        v = (v << 1) | bits_(1);
+        return v - 0x190 + 144;
+    }
+
+private:
+    const std::vector<std::byte>& in_;
+    std::size_t pos_ = 0;
+};
+
+static int failures = 0;
+
+static void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cerr << "FAIL: " << what << '\n';
+        ++failures;
+    }
+}
+
+static std::vector<std::byte> bytes(const std::string& s) {
+    auto b = std::as_bytes(std::span(s));
+    return {b.begin(), b.end()};
+}
+
+static void roundTrip(const std::vector<std::byte>& data, 
+                      const std::string& name)
+{
+    try {
+        auto packed = jar::deflate(data);
+        check(Inflater(packed).run() == data, "deflate round trip: " + name);
+    } catch (const std::exception& e) {
+        check(false, "deflate round trip: " + name + ": " + e.what());
+    }
+}
+
+int main() {
+    // crc32: контрольное значение из стандарта
+    check(0 == jar::crc32({}), "crc32 of empty input");
+    check(0xcbf43926u == jar::crc32(bytes("123456789")), 
+          "crc32(\"123456789\")");
+
+    roundTrip({}, "empty");
+    roundTrip(bytes("a"), "one byte");
+    roundTrip(bytes("abcabcabcabcabcabcabc"), "short repeats");
+    roundTrip(std::vector<std::byte>(1000, std::byte('x')), 
+              "run longer than max match");
+
+    // все 256 значений байта и дальние совпадения
+    std::vector<std::byte> mixed;
+    std::uint32_t seed = 12345;
+    for (int i = 0; i < 40000; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        mixed.push_back(std::byte(seed >> 16));
+    }
+    mixed.insert(mixed.end(), mixed.begin() + 100, mixed.begin() + 5000);
+    roundTrip(mixed, "pseudo-random with a far match");
+
+    auto text = bytes("public static void main(String[] args)\n");
+    for (int i = 0; i < 6; ++i) {
+        text.insert(text.end(), text.begin(), text.end());
+    }
+    auto packed = jar::deflate(text);
+    check(packed.size() < text.size() / 4, "repetitive text compresses");
+
+    // jar: манифест - первая запись
+    jar::JarWriter jw(jar::Compression::DEFLATE);
+    jw.setMainClass("pkg/Main");
+    jw.add("pkg/Main.class", text);
+    auto archive = jw.finish();
+    std::string head(reinterpret_cast<const char*>(archive.data()), 
+                     std::min<std::size_t>(archive.size(), 50));
+    check(head.starts_with("PK\x03\x04"), "jar starts with a local header");
+    check(std::string::npos != head.find("META-INF/MANIFEST.MF"), 
+          "manifest is the first entry");
+
+    if (failures) {
+        return EXIT_FAILURE;
+    }
+    std::cout << "jar_test: ok\n";
+    return 0;
+}
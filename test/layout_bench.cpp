@@ -0,0 +1,85 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "codegen.hpp"
+
+// синтетический метод: n операторов "i := i + 1",
+// каждые 16 операторов - новый bb с goto на него
+static std::vector<std::byte> build(std::size_t n,
+                         codegen::LayoutMode mode,
+                         double& ms)
+{
+    codegen::JavaBCCodegen cd(49, 0);
+    attribute::QualifiedName name("Bench");
+    auto cls = cd.createClass(name);
+    cls->addAccesFlag(codegen::AccessFlag::ACC_PUBLIC);
+
+    auto type =
+        descriptor::JVMMethodDescriptor::createVoidParamsVoidReturn();
+    auto func = cls->addMethod("run", type);
+    func->addFlag(codegen::AccessFlag::ACC_PUBLIC);
+    func->addFlag(codegen::AccessFlag::ACC_STATIC);
+    func->setLayoutMode(mode);
+
+    auto start = std::chrono::steady_clock::now();
+    func->createLocalInt("i");
+    auto bb = func->createBB();
+    func->createIconst(bb, 0);
+    func->createIstore(bb, "i");
+    for (std::size_t s = 0; s < n; ++s) {
+        if (s && 0 == s % 16) {
+            auto next = func->createBB();
+            func->createGoto(bb, next);
+            bb = next;
+        }
+        func->createIload(bb, "i");
+        func->createIconst(bb, 1);
+        func->createIadd(bb);
+        func->createIstore(bb, "i");
+    }
+    func->createReturn(bb);
+    cls->finalize();
+    auto end = std::chrono::steady_clock::now();
+    ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    return cls->bytes();
+}
+
+// usage: layout_bench [statements] [--eager | --skip-eager]
+// EAGER квадратичен (50000 операторов - минуты),
+// поэтому по умолчанию меряется только DEFERRED
+int main(int argc, char** argv) {
+    std::size_t n = 50000;
+    bool skipEager = true;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        if ("--eager" == arg) {
+            skipEager = false;
+        } else if ("--skip-eager" == arg) {
+            skipEager = true;
+        } else {
+            n = std::stoul(arg);
+        }
+    }
+
+    double deferredMs = 0;
+    auto deferred =
+        build(n, codegen::LayoutMode::DEFERRED, deferredMs);
+    std::cout << "statements: " << n << '\n';
+    std::cout << "deferred:   " << deferredMs << " ms\n";
+    if (skipEager) {
+        return 0;
+    }
+
+    double eagerMs = 0;
+    auto eager = build(n, codegen::LayoutMode::EAGER, eagerMs);
+    std::cout << "eager:      " << eagerMs << " ms\n";
+    if (eager != deferred) {
+        std::cerr << "layout mismatch\n";
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
@@ -0,0 +1,19 @@
+with Ada.Text_IO; use Ada.Text_IO;
+
+procedure TestConst is
+   N    : constant Integer := 4 * 1024;
+   Half : constant Integer := N / 2;
+   Eps  : constant Float := 1.0 / 4.0;
+   Msg  : constant String := "N = ";
+   X    : Integer := Half - 1;
+begin
+   Put_Line(Msg & Integer'Image(N));
+   Put_Line("Half = " & Integer'Image(Half));
+   if N > 1000 and True then
+      Put_Line("big" & " " & Boolean'Image(Eps < 1.0));
+   end if;
+   while X < Half + 2 loop
+      X := X + 1;
+   end loop;
+   Put_Line(Integer'Image(X));
+end TestConst;
@@ -0,0 +1,43 @@
+with Ada.Text_IO; use Ada.Text_IO;
+
+procedure TestLoopIndexing is
+   type Matrix is array(1..4, 1..8) of Integer;
+
+   m: Matrix;
+
+   --  k вне 1..8: обращение под if не выполняется
+   procedure Guarded(a: Matrix; n: Integer; k: Integer) is
+      s: Integer := 0;
+   begin
+      for j in 1..n loop
+         Put_Line("guarded j: " & Integer'Image(j));
+         if k <= 8 then
+            s := s + a(j, k);
+         end if;
+      end loop;
+      Put_Line("guarded sum: " & Integer'Image(s));
+   end Guarded;
+
+   --  n = 0: тело не выполняется ни разу
+   procedure ZeroTrip(a: Matrix; n: Integer; k: Integer) is
+      s: Integer := 0;
+   begin
+      Put_Line("zero-trip start");
+      for j in 1..n loop
+         s := s + a(j, k);
+      end loop;
+      Put_Line("zero-trip sum: " & Integer'Image(s));
+   end ZeroTrip;
+
+begin
+   for i in 1..4 loop
+      for j in 1..8 loop
+         m(i, j) := i * 10 + j;
+      end loop;
+   end loop;
+
+   Guarded(m, 4, 2);     --  12 + 22 + 32 + 42 = 108
+   Guarded(m, 4, 9);     --  0, без исключения
+   ZeroTrip(m, 0, 9);    --  0, без исключения
+   ZeroTrip(m, 2, 8);    --  18 + 28 = 46
+end TestLoopIndexing;
@@ -0,0 +1,25 @@
+with Ada.Text_IO; use Ada.Text_IO;
+
+procedure TestStrings is
+   hello: String(1..5) := "Hello";
+   world: String(1..5) := "World";
+   both: String(1..11);
+   c: Character;
+
+begin
+   Put_Line(hello);
+   Put_Line(world);
+
+   --  индексация: чтение и запись
+   c := hello(1);
+   hello(1) := world(1);
+   world(1) := c;
+   Put_Line(hello);
+   Put_Line(world);
+
+   --  конкатенация
+   both := hello & " " & world;
+   Put_Line(both);
+   Put_Line(world & hello);
+   Put_Line(Integer'Image(42) & "!");
+end TestStrings;